@@ -5,4 +5,60 @@ function(target_set_common_properties target_name)
 
     # add a clean DEBUG preprocessor define if applicable
     target_compile_definitions(${target_name} PRIVATE $<$<CONFIG:Debug>:DEBUG>)
-endfunction()
\ No newline at end of file
+endfunction()
+
+set(CHIP8_CPP_EMBED_PROGRAMS_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/embed_programs.cmake)
+
+# Embeds Chip-8 programs into a target as constant arrays, so they can be loaded without any file I/O.
+# Generates <NAME>.hpp, which lists the programs in NAME::EmbeddedPrograms and finds them with NAME::findProgram().
+#   target_embed_programs(my_target NAME my_programs FILES a.ch8 b.ch8)
+function(target_embed_programs target_name)
+    cmake_parse_arguments(ARG "" "NAME" "FILES" ${ARGN})
+
+    set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/embedded_programs)
+    set(header ${output_dir}/include/${ARG_NAME}.hpp)
+    set(source ${output_dir}/${ARG_NAME}.cpp)
+
+    # Lists can't be passed through a custom command as is
+    string(REPLACE ";" "|" files "${ARG_FILES}")
+
+    add_custom_command(
+            OUTPUT ${header} ${source}
+            COMMAND ${CMAKE_COMMAND} -DNAME=${ARG_NAME} -DHEADER=${header} -DSOURCE=${source} -DFILES=${files}
+            -P ${CHIP8_CPP_EMBED_PROGRAMS_SCRIPT}
+            DEPENDS ${ARG_FILES} ${CHIP8_CPP_EMBED_PROGRAMS_SCRIPT}
+            COMMENT "Embedding programs into ${ARG_NAME}"
+            VERBATIM
+    )
+
+    target_sources(${target_name} PRIVATE ${header} ${source})
+    target_include_directories(${target_name} PRIVATE ${output_dir}/include)
+endfunction()
+
+# Compiles a Chip-8 program to native code with chip8cpp-aot into a static library target linking chip8cpp.
+# Generates <NAME>.hpp, which declares NAME::Program to load with Chip8::loadProgram() and run with
+# Chip8::emulateCycles().
+#   add_compiled_program(my_program NAME my_program PROGRAM game.ch8)
+function(add_compiled_program target_name)
+    cmake_parse_arguments(ARG "" "NAME;PROGRAM" "" ${ARGN})
+
+    get_filename_component(program ${ARG_PROGRAM} ABSOLUTE)
+
+    set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/compiled_programs/${ARG_NAME})
+    set(header ${output_dir}/include/${ARG_NAME}.hpp)
+    set(source ${output_dir}/${ARG_NAME}.cpp)
+
+    add_custom_command(
+            OUTPUT ${header} ${source}
+            COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir}/include
+            COMMAND chip8cpp-aot --name ${ARG_NAME} --header ${header} --source ${source} ${program}
+            DEPENDS chip8cpp-aot ${program}
+            COMMENT "Compiling ${ARG_PROGRAM} to native code"
+            VERBATIM
+    )
+
+    add_library(${target_name} STATIC ${header} ${source})
+    target_link_libraries(${target_name} PUBLIC chip8cpp)
+    target_set_common_properties(${target_name})
+    target_include_directories(${target_name} PUBLIC ${output_dir}/include)
+endfunction()
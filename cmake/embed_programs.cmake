@@ -0,0 +1,75 @@
+# Script mode helper of target_embed_programs(), writes HEADER and SOURCE holding every file in FILES.
+# Usage: cmake -DNAME=<namespace> -DHEADER=<file.hpp> -DSOURCE=<file.cpp> -DFILES=<a.ch8|b.ch8> -P embed_programs.cmake
+
+string(REPLACE "|" ";" files "${FILES}")
+list(LENGTH files program_count)
+get_filename_component(header_name ${HEADER} NAME)
+
+set(arrays "")
+set(entries "")
+set(index 0)
+foreach (file IN LISTS files)
+    get_filename_component(program_name ${file} NAME_WE)
+    file(READ ${file} hex HEX)
+    string(LENGTH "${hex}" hex_length)
+    math(EXPR program_size "${hex_length} / 2")
+
+    if (program_size EQUAL 0)
+        set(bytes "0x00")
+    else ()
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " bytes "${hex}")
+    endif ()
+
+    string(APPEND arrays "    alignas(64) constexpr uint8_t Program${index}[] = {${bytes}};\n")
+    string(APPEND entries "        EmbeddedProgram {\"${program_name}\", std::span<const uint8_t>(Program${index}, ${program_size})},\n")
+    math(EXPR index "${index} + 1")
+endforeach ()
+
+file(WRITE ${HEADER} "// Generated by target_embed_programs(), do not edit.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace ${NAME}
+{
+    struct EmbeddedProgram
+    {
+        std::string_view         name; // File name without extension
+        std::span<const uint8_t> data; // Program bytes
+    };
+
+    extern const std::array<EmbeddedProgram, ${program_count}> EmbeddedPrograms;
+
+    // Returns an empty span when there is no program with that name
+    std::span<const uint8_t> findProgram(std::string_view name);
+} // namespace ${NAME}
+")
+
+file(WRITE ${SOURCE} "// Generated by target_embed_programs(), do not edit.
+#include \"${header_name}\"
+
+namespace
+{
+${arrays}} // namespace
+
+namespace ${NAME}
+{
+    const std::array<EmbeddedProgram, ${program_count}> EmbeddedPrograms = {
+${entries}    };
+
+    std::span<const uint8_t> findProgram(std::string_view name)
+    {
+        for (const EmbeddedProgram& program : EmbeddedPrograms)
+        {
+            if (program.name == name)
+            {
+                return program.data;
+            }
+        }
+        return {};
+    }
+} // namespace ${NAME}
+")
@@ -0,0 +1,118 @@
+#include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp_compiled_programs.hpp>
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+
+namespace
+{
+    using chip8cpp_compiled_programs::CompiledTestProgram;
+
+    // Instructions each program runs per chunk size
+    constexpr uint32_t CycleCount = 5000;
+
+    // Instructions per emulateCycles() call, each size stops native blocks at different instructions
+    constexpr uint32_t ChunkSizes[] = {1, 3, 7, 13};
+
+    // Instructions a key is held for, before the next key or no key
+    constexpr uint32_t KeyHoldCycles = 64;
+
+    bool isSameState(const chip8cpp::Snapshot& a, const chip8cpp::Snapshot& b)
+    {
+        return std::ranges::equal(a.V, b.V) && a.I == b.I && a.PC == b.PC && a.SP == b.SP &&
+               a.delayTimer == b.delayTimer && a.soundTimer == b.soundTimer && std::ranges::equal(a.stack, b.stack) &&
+               std::ranges::equal(a.keys, b.keys) && std::ranges::equal(a.gfx, b.gfx) &&
+               std::ranges::equal(a.memory, b.memory);
+    }
+
+    // Runs the compiled program and the interpreter side by side, with the same keys held, and compares their
+    // states after every chunk
+    bool checkProgram(const CompiledTestProgram& test, uint32_t chunkSize)
+    {
+        chip8cpp::Config config {};
+        config.printTraps = false; // 8-scrolling traps on its Super-CHIP opcodes
+#ifdef DEBUG
+        config.printKeyStates = false;
+#endif
+
+        chip8cpp::Chip8 native(config);
+        chip8cpp::Chip8 interpreted(config);
+        if (!native.loadProgram(*test.program) || !interpreted.loadProgramView(test.program->program))
+        {
+            std::cerr << test.name << ": failed to load" << std::endl;
+            return false;
+        }
+        native.setRandomSeed(1);
+        interpreted.setRandomSeed(1);
+
+        chip8cpp::Snapshot nativeState;
+        chip8cpp::Snapshot interpretedState;
+        for (uint32_t cycle = 0; cycle < CycleCount; cycle += chunkSize)
+        {
+            // Every key in turn, then none, so key skips and waits take both ways
+            const size_t heldKey = (cycle / KeyHoldCycles) % (chip8cpp::constants::KeyCount + 1);
+            for (size_t key = 0; key < chip8cpp::constants::KeyCount; ++key)
+            {
+                native.setKeyState(static_cast<chip8cpp::KeyCode>(key), key == heldKey);
+                interpreted.setKeyState(static_cast<chip8cpp::KeyCode>(key), key == heldKey);
+            }
+
+            native.emulateCycles(chunkSize);
+            interpreted.emulateCycles(chunkSize);
+
+            native.captureSnapshot(nativeState);
+            interpreted.captureSnapshot(interpretedState);
+            if (!isSameState(nativeState, interpretedState) || native.getStateHash() != interpreted.getStateHash() ||
+                native.getDrawFlag() != interpreted.getDrawFlag())
+            {
+                std::cerr << std::format("{}: differs from the interpreter after {} instructions in chunks of {}, "
+                                         "PC 0x{:03X} native, 0x{:03X} interpreted",
+                                         test.name,
+                                         cycle + chunkSize,
+                                         chunkSize,
+                                         nativeState.PC,
+                                         interpretedState.PC)
+                          << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace
+
+int main()
+try
+{
+    bool isMatching = true;
+    for (const CompiledTestProgram& test : chip8cpp_compiled_programs::CompiledTestPrograms)
+    {
+        for (const uint32_t chunkSize : ChunkSizes)
+        {
+            isMatching = checkProgram(test, chunkSize) && isMatching;
+        }
+    }
+
+    if (!isMatching)
+    {
+        return 1;
+    }
+
+    std::cout << std::format("{} compiled programs match the interpreter for {} instructions in chunks of 1, 3, 7 and "
+                             "13",
+                             std::size(chip8cpp_compiled_programs::CompiledTestPrograms),
+                             CycleCount)
+              << std::endl;
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Unknown exception occurred." << std::endl;
+    return 1;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chip8cpp_aot
+{
+    // How an instruction passes control on, which decides what code is reachable and where blocks end
+    enum class Flow
+    {
+        eNext = 0,      // Continues with the next instruction
+        eJump,          // 1NNN, continues at NNN
+        eCall,          // 2NNN, continues at NNN and later returns to the next instruction
+        eSkip,          // Continues with the next instruction or the one after it
+        eStore,         // Writes memory, which may be the code that follows, so it ends the block
+        eWait,          // FX0A, runs again until a key is pressed
+        eComputedJump,  // BNNN, the target is only known at runtime
+        eStop,          // 00EE or a trap, the target is only known at runtime
+    };
+
+    // Handler of an opcode and its control flow
+    struct DecodedInstruction
+    {
+        std::string handler;              // Handler expression, called with the interpreter and the opcode
+        Flow        flow {Flow::eNext};   // How the instruction passes control on
+        uint16_t    target {0};           // Jump or call target
+        bool        canTrap {false};      // Whether it can stop on itself instead, see chip8cpp::Trap
+    };
+
+    // Run of consecutive instructions compiled to one function, which can be entered at any of them
+    struct Block
+    {
+        uint16_t              startAddress {0}; // Address of the first instruction
+        std::vector<uint16_t> opcodes;          // Opcodes of the instructions
+    };
+
+    // Recompiles a Chip8 program to C++ ahead of time.
+    // Code is found by following the control flow from the program start, the generated code calls the
+    // interpreter's instruction handlers with constant opcodes, so the compiler can fold the decoding away.
+    class Recompiler
+    {
+    public:
+        bool loadProgram(const std::string& fileName);
+        void findBlocks();
+
+        bool writeHeader(const std::string& fileName, const std::string& name) const;
+        bool writeSource(const std::string& fileName, const std::string& name, const std::string& header) const;
+
+        size_t getBlockCount() const;
+        size_t getInstructionCount() const;
+
+    private:
+        void writeBlock(std::ostream& file, const Block& block, size_t blockIndex) const;
+
+        bool     isInProgram(uint32_t address) const;
+        uint16_t readOpcode(uint16_t address) const;
+
+        static DecodedInstruction decode(uint16_t opcode);
+
+    private:
+        std::string          m_FileName; // Program file
+        std::vector<uint8_t> m_Program;  // Program bytes, loaded at 0x200
+        std::vector<Block>   m_Blocks;   // Recovered blocks, ordered by address
+    };
+} // namespace chip8cpp_aot
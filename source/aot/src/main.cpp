@@ -0,0 +1,74 @@
+#include <chip8cpp_aot/recompiler.hpp>
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+try
+{
+    std::string name;
+    std::string header;
+    std::string source;
+    std::string program;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--name" && i + 1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (argument == "--header" && i + 1 < argc)
+        {
+            header = argv[++i];
+        }
+        else if (argument == "--source" && i + 1 < argc)
+        {
+            source = argv[++i];
+        }
+        else if (!argument.starts_with("--") && program.empty())
+        {
+            program = argument;
+        }
+        else
+        {
+            program.clear(); // Unknown option or more than one program
+            break;
+        }
+    }
+
+    if (name.empty() || header.empty() || source.empty() || program.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --name <namespace> --header <file.hpp> --source <file.cpp> <program_file>"
+                  << std::endl;
+        return 1;
+    }
+
+    chip8cpp_aot::Recompiler recompiler;
+    if (!recompiler.loadProgram(program))
+    {
+        return 1;
+    }
+
+    recompiler.findBlocks();
+    // The source includes the header by name, they are generated next to each other
+    const std::string headerName = std::filesystem::path(header).filename().string();
+    if (!recompiler.writeHeader(header, name) || !recompiler.writeSource(source, name, headerName))
+    {
+        return 1;
+    }
+
+    std::cout << "Compiled " << program << ": " << recompiler.getBlockCount() << " blocks, "
+              << recompiler.getInstructionCount() << " instructions" << std::endl;
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Unknown exception occurred." << std::endl;
+    return 1;
+}
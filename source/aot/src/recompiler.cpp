@@ -0,0 +1,494 @@
+#include <chip8cpp_aot/recompiler.hpp>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace
+{
+    using chip8cpp_aot::DecodedInstruction;
+    using chip8cpp_aot::Flow;
+
+    constexpr size_t MaxProgramSize = chip8cpp::constants::MemorySize - chip8cpp::constants::ProgramStartAddress;
+
+    // Handler taking the X register as a template parameter, e.g. setImmediate<0x3>
+    DecodedInstruction withX(const char* name, uint16_t opcode, Flow flow = Flow::eNext)
+    {
+        return {std::format("Instructions::{}<0x{:X}>", name, (opcode & 0x0F00) >> 8), flow};
+    }
+
+    // Handler taking the X and Y registers as template parameters, e.g. add<0x3, 0x4>
+    DecodedInstruction withXY(const char* name, uint16_t opcode, Flow flow = Flow::eNext)
+    {
+        return {std::format("Instructions::{}<0x{:X}, 0x{:X}>", name, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4),
+                flow};
+    }
+
+    // Handler of a memory instruction, instantiated without the debugger hooks, native code never runs with them.
+    // It traps when the access would go past the end of memory.
+    DecodedInstruction withHooksAndX(const char* name, uint16_t opcode, Flow flow)
+    {
+        return {std::format("Instructions::{}<NoHooks, 0x{:X}>", name, (opcode & 0x0F00) >> 8), flow, 0, true};
+    }
+
+    const DecodedInstruction UnknownOpcode {"Instructions::trapUnknownOpcode", Flow::eStop};
+} // namespace
+
+namespace chip8cpp_aot
+{
+    bool Recompiler::loadProgram(const std::string& fileName)
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open program: " << fileName << std::endl;
+            return false;
+        }
+
+        m_Program.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (m_Program.empty() || m_Program.size() > MaxProgramSize)
+        {
+            std::cerr << "Program is empty or too large to fit in memory: " << fileName << std::endl;
+            return false;
+        }
+
+        m_FileName = fileName;
+        return true;
+    }
+
+    void Recompiler::findBlocks()
+    {
+        m_Blocks.clear();
+
+        // Follow the control flow from the program start. Code only reachable through BNNN or a return isn't found
+        // and stays interpreted.
+        std::vector<bool>     isReachable(chip8cpp::constants::MemorySize, false);
+        std::vector<uint32_t> worklist {chip8cpp::constants::ProgramStartAddress};
+        while (!worklist.empty())
+        {
+            const uint32_t address = worklist.back();
+            worklist.pop_back();
+            if (!isInProgram(address) || isReachable[address])
+            {
+                continue;
+            }
+            isReachable[address] = true;
+
+            const DecodedInstruction instruction = decode(readOpcode(static_cast<uint16_t>(address)));
+            switch (instruction.flow)
+            {
+                case Flow::eJump:
+                    worklist.push_back(instruction.target);
+                    break;
+                case Flow::eCall:
+                    worklist.push_back(instruction.target);
+                    worklist.push_back(address + 2); // Where the subroutine returns to
+                    break;
+                case Flow::eSkip:
+                    worklist.push_back(address + 2);
+                    worklist.push_back(address + 4);
+                    break;
+                case Flow::eComputedJump:
+                case Flow::eStop:
+                    break;
+                default:
+                    worklist.push_back(address + 2);
+                    break;
+            }
+        }
+
+        // A block is a run of reachable instructions up to a return, a computed jump, a trap or a store.
+        // Jumps, calls and skips to instructions of the same block stay in native code.
+        std::vector<bool> isCovered(chip8cpp::constants::MemorySize, false);
+        for (uint32_t start = chip8cpp::constants::ProgramStartAddress; start < chip8cpp::constants::MemorySize; ++start)
+        {
+            if (!isReachable[start] || isCovered[start])
+            {
+                continue;
+            }
+
+            Block& block       = m_Blocks.emplace_back();
+            block.startAddress = static_cast<uint16_t>(start);
+            for (uint32_t address = start; address < chip8cpp::constants::MemorySize && isReachable[address];
+                 address += 2)
+            {
+                const uint16_t opcode = readOpcode(static_cast<uint16_t>(address));
+                isCovered[address]    = true;
+                block.opcodes.push_back(opcode);
+
+                const Flow flow = decode(opcode).flow;
+                if (flow == Flow::eComputedJump || flow == Flow::eStop || flow == Flow::eStore)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    bool Recompiler::writeHeader(const std::string& fileName, const std::string& name) const
+    {
+        std::ofstream file(fileName);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open header: " << fileName << std::endl;
+            return false;
+        }
+
+        file << "// Generated by chip8cpp-aot from " << m_FileName << ", do not edit.\n"
+             << "#pragma once\n"
+             << "\n"
+             << "#include <chip8cpp/chip8cpp.hpp>\n"
+             << "\n"
+             << "namespace " << name << "\n"
+             << "{\n"
+             << "    // Load with chip8cpp::Chip8::loadProgram() and run with chip8cpp::Chip8::emulateCycles()\n"
+             << "    extern const chip8cpp::CompiledProgram Program;\n"
+             << "} // namespace " << name << "\n";
+
+        return static_cast<bool>(file);
+    }
+
+    bool Recompiler::writeSource(const std::string& fileName, const std::string& name, const std::string& header) const
+    {
+        std::ofstream file(fileName);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open source: " << fileName << std::endl;
+            return false;
+        }
+
+        file << "// Generated by chip8cpp-aot from " << m_FileName << ", do not edit.\n"
+             << "#include \"" << header << "\"\n"
+             << "\n"
+             << "#include <chip8cpp/detail/instructions.hpp>\n"
+             << "\n"
+             << "#include <array>\n"
+             << "#include <cstdint>\n"
+             << "\n"
+             << "namespace\n"
+             << "{\n"
+             << "    using chip8cpp::detail::Instructions;\n"
+             << "    using chip8cpp::detail::NoHooks;\n"
+             << "\n";
+
+        // The program bytes, loaded like an embedded program
+        file << "    constexpr uint8_t ProgramBytes[] = {";
+        for (size_t i = 0; i < m_Program.size(); ++i)
+        {
+            file << (i % 16 == 0 ? "\n        " : " ") << std::format("0x{:02X},", m_Program[i]);
+        }
+        file << "\n    };\n";
+
+        // One function per block
+        for (size_t blockIndex = 0; blockIndex < m_Blocks.size(); ++blockIndex)
+        {
+            writeBlock(file, m_Blocks[blockIndex], blockIndex);
+        }
+
+        // The blocks and the address to block lookup
+        file << "\n"
+             << "    constexpr chip8cpp::CompiledBlock Blocks[] = {\n";
+        for (size_t blockIndex = 0; blockIndex < m_Blocks.size(); ++blockIndex)
+        {
+            const Block& block    = m_Blocks[blockIndex];
+            uint64_t     lineMask = 0;
+            for (size_t i = 0; i < block.opcodes.size() * 2; ++i)
+            {
+                lineMask |= uint64_t {1} << ((block.startAddress + i) / chip8cpp::constants::LineSize);
+            }
+
+            file << std::format("        {{0x{:03X}, {}, 0x{:016X}, &runBlock{}}},\n",
+                                block.startAddress,
+                                block.opcodes.size(),
+                                lineMask,
+                                blockIndex);
+        }
+        file << "    };\n"
+             << "\n"
+             << "    constexpr std::array<uint16_t, chip8cpp::constants::MemorySize> BlockIndex = []()\n"
+             << "    {\n"
+             << "        std::array<uint16_t, chip8cpp::constants::MemorySize> blockIndex {};\n"
+             << "        for (size_t block = 0; block < std::size(Blocks); ++block)\n"
+             << "        {\n"
+             << "            for (size_t i = 0; i < Blocks[block].instructionCount; ++i)\n"
+             << "            {\n"
+             << "                blockIndex[Blocks[block].startAddress + i * 2] = static_cast<uint16_t>(block + 1);\n"
+             << "            }\n"
+             << "        }\n"
+             << "        return blockIndex;\n"
+             << "    }();\n"
+             << "} // namespace\n"
+             << "\n"
+             << "namespace " << name << "\n"
+             << "{\n"
+             << "    const chip8cpp::CompiledProgram Program {ProgramBytes, Blocks, BlockIndex};\n"
+             << "} // namespace " << name << "\n";
+
+        return static_cast<bool>(file);
+    }
+
+    void Recompiler::writeBlock(std::ostream& file, const Block& block, size_t blockIndex) const
+    {
+        // Index of the instruction at an address, if it is in this block
+        const auto findInstruction = [&block](uint32_t address) -> std::optional<size_t>
+        {
+            const uint32_t offset = address - block.startAddress;
+            if (address < block.startAddress || offset % 2 != 0 || offset / 2 >= block.opcodes.size())
+            {
+                return std::nullopt;
+            }
+            return offset / 2;
+        };
+
+        // Where each instruction can continue, and which of those are in the block. While it stays in the block,
+        // the function keeps running without going back to the interpreter. No store ran since the block was
+        // entered, a store ends it, so its memory still holds the compiled instructions.
+        std::vector<std::vector<uint32_t>> successors(block.opcodes.size());
+        std::vector<std::vector<size_t>>   localSuccessors(block.opcodes.size());
+        bool                               usesBudget = false;
+        for (size_t i = 0; i < block.opcodes.size(); ++i)
+        {
+            const uint32_t           address     = block.startAddress + i * 2;
+            const DecodedInstruction instruction = decode(block.opcodes[i]);
+            switch (instruction.flow)
+            {
+                case Flow::eJump:
+                case Flow::eCall:
+                    successors[i] = {instruction.target};
+                    break;
+                case Flow::eSkip:
+                    successors[i] = {address + 2, address + 4};
+                    break;
+                case Flow::eWait:
+                    successors[i] = {address + 2, address}; // Runs again until a key is pressed
+                    break;
+                case Flow::eComputedJump:
+                case Flow::eStop:
+                case Flow::eStore:
+                    break; // Leaves the block
+                default:
+                    successors[i] = {address + 2};
+                    break;
+            }
+            if (instruction.canTrap && !successors[i].empty())
+            {
+                successors[i].push_back(address); // A trap leaves the PC on the instruction, it runs again
+            }
+
+            for (const uint32_t successor : successors[i])
+            {
+                if (const std::optional<size_t> index = findInstruction(successor))
+                {
+                    localSuccessors[i].push_back(*index);
+                }
+            }
+            usesBudget |= !localSuccessors[i].empty();
+        }
+
+        file << "\n"
+             << std::format("    // 0x{:03X}-0x{:03X}\n",
+                            block.startAddress,
+                            block.startAddress + block.opcodes.size() * 2 - 1)
+             << std::format("    uint32_t runBlock{}(chip8cpp::Chip8& chip8, uint32_t entry, uint32_t{})\n",
+                            blockIndex,
+                            usesBudget ? " cycleBudget" : "")
+             << "    {\n"
+             << "        uint32_t cycleCount = 0;\n"
+             << "        switch (entry)\n"
+             << "        {\n";
+        for (size_t i = 0; i < block.opcodes.size(); ++i)
+        {
+            file << std::format("            case {0}: goto instruction{0};\n", i);
+        }
+        file << "            default: return 0;\n"
+             << "        }\n";
+
+        for (size_t i = 0; i < block.opcodes.size(); ++i)
+        {
+            const uint32_t address = block.startAddress + i * 2;
+            const uint16_t opcode  = block.opcodes[i];
+
+            file << "\n"
+                 << std::format("    instruction{}: // 0x{:03X}: {:04X}\n", i, address, opcode)
+                 << std::format("        {}(chip8, 0x{:04X});\n", decode(opcode).handler, opcode)
+                 << "        Instructions::endCycle(chip8);\n";
+
+            if (localSuccessors[i].empty())
+            {
+                file << "        return cycleCount + 1;\n";
+                continue;
+            }
+
+            file << "        if (++cycleCount == cycleBudget)\n"
+                 << "        {\n"
+                 << "            return cycleCount;\n"
+                 << "        }\n";
+
+            // Only instructions with more than one successor check where they went, the next instruction is reached
+            // by falling through
+            bool fallsThrough = false;
+            for (size_t k = 0; k < successors[i].size(); ++k)
+            {
+                const std::optional<size_t> index = findInstruction(successors[i][k]);
+                if (index == i + 1)
+                {
+                    fallsThrough = true;
+                }
+                else if (index && successors[i].size() == 1)
+                {
+                    file << std::format("        goto instruction{};\n", *index);
+                }
+                else if (index)
+                {
+                    file << std::format("        if (Instructions::getPC(chip8) == 0x{:03X})\n", successors[i][k])
+                         << "        {\n"
+                         << std::format("            goto instruction{};\n", *index)
+                         << "        }\n";
+                }
+            }
+
+            if (!fallsThrough && successors[i].size() > 1)
+            {
+                file << "        return cycleCount;\n";
+            }
+            else if (fallsThrough && localSuccessors[i].size() < successors[i].size())
+            {
+                file << std::format("        if (Instructions::getPC(chip8) != 0x{:03X})\n", address + 2)
+                     << "        {\n"
+                     << "            return cycleCount;\n"
+                     << "        }\n";
+            }
+        }
+
+        file << "    }\n";
+    }
+
+    size_t Recompiler::getBlockCount() const { return m_Blocks.size(); }
+
+    size_t Recompiler::getInstructionCount() const
+    {
+        size_t instructionCount = 0;
+        for (const Block& block : m_Blocks)
+        {
+            instructionCount += block.opcodes.size();
+        }
+        return instructionCount;
+    }
+
+    bool Recompiler::isInProgram(uint32_t address) const
+    {
+        // Both bytes of the instruction have to be part of the program
+        return address >= chip8cpp::constants::ProgramStartAddress &&
+               address + 1 < chip8cpp::constants::ProgramStartAddress + m_Program.size();
+    }
+
+    uint16_t Recompiler::readOpcode(uint16_t address) const
+    {
+        const size_t offset = address - chip8cpp::constants::ProgramStartAddress;
+        return static_cast<uint16_t>((m_Program[offset] << 8) | m_Program[offset + 1]);
+    }
+
+    DecodedInstruction Recompiler::decode(uint16_t opcode)
+    {
+        // Same decoding as the interpreter's dispatch table
+        switch (opcode & 0xF000)
+        {
+            case 0x0000:
+                switch (opcode & 0x00FF)
+                {
+                    case 0x00E0:
+                        return {"Instructions::clearScreen"};
+                    case 0x00EE:
+                        return {"Instructions::returnFromSubroutine", Flow::eStop};
+                    default:
+                        return UnknownOpcode;
+                }
+            case 0x1000:
+                return {"Instructions::jump", Flow::eJump, static_cast<uint16_t>(opcode & 0x0FFF)};
+            case 0x2000:
+                return {"Instructions::call", Flow::eCall, static_cast<uint16_t>(opcode & 0x0FFF), true};
+            case 0x3000:
+                return withX("skipIfEqualImmediate", opcode, Flow::eSkip);
+            case 0x4000:
+                return withX("skipIfNotEqualImmediate", opcode, Flow::eSkip);
+            case 0x5000:
+                return withXY("skipIfEqual", opcode, Flow::eSkip);
+            case 0x6000:
+                return withX("setImmediate", opcode);
+            case 0x7000:
+                return withX("addImmediate", opcode);
+            case 0x8000:
+                switch (opcode & 0x000F)
+                {
+                    case 0x0000:
+                        return withXY("set", opcode);
+                    case 0x0001:
+                        return withXY("bitwiseOr", opcode);
+                    case 0x0002:
+                        return withXY("bitwiseAnd", opcode);
+                    case 0x0003:
+                        return withXY("bitwiseXor", opcode);
+                    case 0x0004:
+                        return withXY("add", opcode);
+                    case 0x0005:
+                        return withXY("subtract", opcode);
+                    case 0x0006:
+                        return withXY("shiftRight", opcode);
+                    case 0x0007:
+                        return withXY("subtractReversed", opcode);
+                    case 0x000E:
+                        return withXY("shiftLeft", opcode);
+                    default:
+                        return UnknownOpcode;
+                }
+            case 0x9000:
+                return withXY("skipIfNotEqual", opcode, Flow::eSkip);
+            case 0xA000:
+                return {"Instructions::setIndex"};
+            case 0xB000:
+                return {"Instructions::jumpOffset", Flow::eComputedJump};
+            case 0xC000:
+                return withX("random", opcode);
+            case 0xD000:
+                return {"Instructions::draw<NoHooks>", Flow::eNext, 0, true};
+            case 0xE000:
+                switch (opcode & 0x00FF)
+                {
+                    case 0x009E:
+                        return withX("skipIfKeyPressed", opcode, Flow::eSkip);
+                    case 0x00A1:
+                        return withX("skipIfKeyNotPressed", opcode, Flow::eSkip);
+                    default:
+                        return UnknownOpcode;
+                }
+            default: // 0xF000
+                switch (opcode & 0x00FF)
+                {
+                    case 0x0007:
+                        return withX("getDelayTimer", opcode);
+                    case 0x000A:
+                        return withX("waitForKey", opcode, Flow::eWait);
+                    case 0x0015:
+                        return withX("setDelayTimer", opcode);
+                    case 0x0018:
+                        return withX("setSoundTimer", opcode);
+                    case 0x001E:
+                        return withX("addToIndex", opcode);
+                    case 0x0029:
+                        return withX("setIndexToDigit", opcode);
+                    case 0x0033:
+                        return withHooksAndX("storeBCD", opcode, Flow::eStore);
+                    case 0x0055:
+                        return withHooksAndX("storeRegisters", opcode, Flow::eStore);
+                    case 0x0065:
+                        return withHooksAndX("loadRegisters", opcode, Flow::eNext);
+                    default:
+                        return UnknownOpcode;
+                }
+        }
+    }
+} // namespace chip8cpp_aot
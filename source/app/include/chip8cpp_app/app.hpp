@@ -3,9 +3,53 @@
 #define SDL_MAIN_HANDLED // Prevents SDL from defining main() on Windows
 #include <SDL.h>
 #include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp_app/frame_pacer.hpp>
+#include <chip8cpp_app/overlay.hpp>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace chip8cpp_app
 {
+    // Command line options
+    struct AppOptions
+    {
+        std::string programFile;               // Program to load
+        std::string builtinProgram;            // Embedded program to load instead of a file
+        bool        vsync {false};             // Whether to sync frames to the display refresh
+        bool        overlay {false};           // Whether to show the ImGui performance overlay
+        std::string frameTimesFile;            // CSV file to export frame times to on exit
+        uint32_t    runAheadFrames {0};        // Frames to run ahead of the real state, 0 disables run-ahead
+        uint32_t    fastForwardMultiplier {4}; // Emulated frames per frame while fast-forward is toggled on
+    };
+
+    // Key change taken from an SDL key event, stamped with the event time in milliseconds
+    struct InputEvent
+    {
+        uint32_t          timestamp {0};
+        chip8cpp::KeyCode keyCode {chip8cpp::KeyCode::eNum0};
+        bool              isPressed {false};
+    };
+
+    // Input-to-photon latency, from a key press to the first presented frame that differs from the same frames run
+    // without it. One key press is measured at a time, from the first one of a frame, and fast-forward drops it.
+    struct LatencyStats
+    {
+        uint32_t sampleCount {0};
+        uint64_t totalMs {0};
+        uint32_t maxMs {0};
+    };
+
+    // CPU time spent running ahead, saving and restoring the real state included
+    struct RunAheadStats
+    {
+        uint32_t frameCount {0};
+        double   totalUs {0.0};
+        double   maxUs {0.0};
+    };
+
     class App
     {
     public:
@@ -16,13 +60,53 @@ namespace chip8cpp_app
         void run();
 
     private:
+        bool parseArguments(int argc, char* argv[]);
+        void reportStats();
+        void updateWindowTitle();
+
         void draw();
-        void setKeyStates();
+        void handleKeyEvent(const SDL_KeyboardEvent& keyEvent);
+        void emulateFrame(uint32_t frameStart);
+        void applyInputEvents(uint32_t until);
+        void measureInputLatency();
+        void beginRunAhead();
+        void endRunAhead();
+        bool isFastForwarding() const;
+        void setFastForward(bool isHeld, bool isToggled);
+        void fastForward();
 
     private:
+        AppOptions        m_Options {};         // Command line options
         chip8cpp::Chip8   m_Chip8;              // Instance of the Chip8 interpreter
+        FramePacer        m_FramePacer;         // Paces frames to 60 FPS and records frame times
         SDL_Window*       m_Window {nullptr};   // SDL window for rendering
         SDL_Renderer*     m_Renderer {nullptr}; // SDL renderer for drawing
         SDL_AudioDeviceID m_AudioDeviceID {0};  // SDL audio device ID for sound output
+        uint32_t          m_CyclesPerFrame {1}; // Instructions executed per frame
+        uint32_t          m_LastFrameStart {0}; // Start time of the previous frame in milliseconds
+
+        std::array<std::optional<chip8cpp::KeyCode>, SDL_NUM_SCANCODES> m_ScancodeToKey {}; // Scancode to Chip8 key
+
+        std::vector<InputEvent>   m_InputEvents;                             // Pending key changes, oldest first
+        std::optional<InputEvent> m_PendingInput;                            // Measured key press not yet on screen
+        uint64_t                  m_LastGFX[chip8cpp::constants::Height] {}; // Graphics buffer of the previous frame
+        LatencyStats              m_InputLatency {};                         // Input-to-photon latency samples
+        chip8cpp::Checkpoint      m_LatencyCheckpoint {};                    // Run without the measured key press
+        chip8cpp::Checkpoint      m_LatencyShownCheckpoint {};               // Shown state while that run steps
+
+        Overlay            m_Overlay;              // ImGui performance overlay
+        chip8cpp::Snapshot m_Snapshot {};          // Interpreter state shown by the overlay, taken once per frame
+        PCHeatmap          m_PCHeatmap {};         // Executions per instruction address
+        uint64_t           m_InstructionCount {0}; // Instructions executed since start
+
+        chip8cpp::Checkpoint        m_RunAheadCheckpoint {};  // Real state while the speculative frames are shown
+        bool                        m_IsRunningAhead {false}; // Whether the interpreter runs speculative frames
+        FramePacer::Clock::duration m_RunAheadTime {};        // Time spent running ahead in the current frame
+        RunAheadStats               m_RunAheadStats {};       // Run-ahead CPU cost
+
+        bool                          m_IsFastForwardHeld {false};    // Tab held, run unthrottled
+        bool                          m_IsFastForwardToggled {false}; // F2 toggled, run at the fixed multiplier
+        uint64_t                      m_EmulatedFrameCount {0};       // Emulated frames since the title update
+        FramePacer::Clock::time_point m_TitleUpdateTime {};           // Time of the last title update
     };
 } // namespace chip8cpp_app
\ No newline at end of file
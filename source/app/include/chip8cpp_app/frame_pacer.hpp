@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace chip8cpp_app
+{
+    // Frame time percentiles over the most recent frames, in milliseconds
+    struct FrameTimeStats
+    {
+        double p50Ms {0.0};
+        double p99Ms {0.0};
+        double maxMs {0.0};
+        size_t sampleCount {0};
+    };
+
+    // Paces frames against absolute deadlines on a monotonic clock, so rounding and oversleeping never accumulate.
+    // Waits sleep for most of the frame and spin for the rest, the spin window adapts to how late sleeps wake up.
+    // With vsync the presented frame already blocks on the display refresh, so the pacer only records frame times,
+    // and the caller has to present every frame.
+    class FramePacer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t HistorySize = 600; // Number of recorded frame times (10 seconds at 60 FPS)
+
+        explicit FramePacer(double targetFPS = 60.0);
+
+        void setVSync(bool enabled);
+        bool isVSync() const;
+
+        void beginFrame();
+        void endFrame();
+
+        Clock::time_point getFrameStart() const;
+        Clock::duration   getFramePeriod() const;
+
+        size_t         getFrameCount() const;
+        FrameTimeStats getStats() const;
+        float          getFrameTimeMs(size_t framesAgo) const;
+
+        bool exportFrameTimes(const std::string& fileName) const;
+
+    private:
+        void waitUntil(Clock::time_point deadline);
+
+    private:
+        Clock::duration   m_FramePeriod;                               // Target duration of a frame
+        Clock::time_point m_NextDeadline {};                           // Absolute end of the current frame
+        Clock::time_point m_FrameStart {};                             // Start of the current frame
+        Clock::duration   m_SpinWindow {std::chrono::milliseconds(2)}; // Time before a deadline spent spinning
+        bool              m_VSync {false};                             // Whether presenting waits for the display
+
+        std::array<float, HistorySize> m_FrameTimesMs {}; // Ring buffer of frame times in milliseconds
+        size_t                         m_FrameCount {0};  // Number of recorded frames
+    };
+} // namespace chip8cpp_app
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SDL.h>
+#include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp_app/frame_pacer.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace chip8cpp_app
+{
+    // Number of times the instruction at each address was executed
+    using PCHeatmap = std::array<uint32_t, chip8cpp::constants::MemorySize>;
+
+    // ImGui performance overlay, drawn on top of the Chip8 display.
+    // It only reads a per-frame snapshot of the interpreter, so it never reaches into the running instance.
+    class Overlay
+    {
+    public:
+        Overlay() = default;
+        ~Overlay();
+
+        Overlay(const Overlay&)            = delete;
+        Overlay& operator=(const Overlay&) = delete;
+
+        bool init(SDL_Window* window);
+        void processEvent(const SDL_Event& event);
+
+        bool isVisible() const;
+        void toggleVisible();
+        bool wantsKeyboard() const;
+
+        void render(const chip8cpp::Snapshot& snapshot,
+                    const PCHeatmap&          pcHeatmap,
+                    const FramePacer&         framePacer,
+                    uint64_t                  instructionCount,
+                    uint32_t&                 cyclesPerFrame);
+
+    private:
+        void drawPerformanceWindow(const FramePacer& framePacer, uint64_t instructionCount, uint32_t& cyclesPerFrame);
+        void drawMachineWindow(const chip8cpp::Snapshot& snapshot);
+        void drawHeatmapWindow(const PCHeatmap& pcHeatmap);
+        void drawMemoryWindow(const chip8cpp::Snapshot& snapshot);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        bool m_Initialized {false}; // Whether the ImGui context and backends are set up
+        bool m_Visible {true};      // Whether the overlay is drawn
+
+        Clock::time_point m_RateSampleTime {};        // Time of the last instructions/sec sample
+        uint64_t          m_RateSampleCount {0};      // Instruction count at the last sample
+        double            m_InstructionsPerSec {0.0}; // Instructions executed per second
+    };
+} // namespace chip8cpp_app
@@ -1,24 +1,20 @@
 #include <chip8cpp_app/app.hpp>
 
 #include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp_programs.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <charconv>
+#include <cstring>
+#include <format>
 #include <iostream>
 
 namespace
 {
-    const std::string                ProgramPathPrefix   = "programs/";
-    const std::array<std::string, 8> BuiltinTestPrograms = {
-        "1-chip8-logo.ch8", // Chip-8 logo
-        "2-ibm-logo.ch8",   // IBM logo
-        "3-corax+.ch8",     // Corax+ demo
-        "4-flags.ch8",      // Flags demo
-        "5-quirks.ch8",     // Quirks demo
-        "6-keypad.ch8",     // Keypad demo
-        "7-beep.ch8",       // Beep sound demo
-        "8-scrolling.ch8"   // Scrolling demo
-    };
+    // Builtin test program loaded by debug builds when none is given
+    constexpr const char* DefaultBuiltinProgram = "2-ibm-logo";
 
     // __  __  __  __
     // |1 ||2 ||3 ||C |
@@ -76,6 +72,21 @@ namespace
         return SDLK_UNKNOWN; // Should never reach here
     }
 
+    // Key presses that cause no visible change within this time are not counted as latency samples
+    constexpr uint32_t InputLatencyTimeoutMs = 1000;
+
+    // Upper bound of --run-ahead, beyond that the speculative frames drift too far from what the player does
+    constexpr uint32_t MaxRunAheadFrames = 8;
+
+    // Upper bound of --fast-forward
+    constexpr uint32_t MaxFastForwardMultiplier = 64;
+
+    // Frames emulated between clock checks while fast-forwarding unthrottled
+    constexpr uint32_t FastForwardBatchFrames = 16;
+
+    // Time left at the end of an unthrottled frame to draw and present it
+    constexpr std::chrono::milliseconds FastForwardPresentTime {2};
+
 #define BEEP_FREQUENCY 440   // Hz
 #define SAMPLE_RATE 44100    // Sample Rate
 #define BEEP_DURATION_MS 200 // Duration
@@ -110,32 +121,54 @@ namespace chip8cpp_app
         // Initialize the Chip8 interpreter with configurations
         chip8cpp::Config config {};
         config.pixelOutline  = true; // Enable pixel outlines for better visibility
-        config.soundCallback = [this]() { playBeep(m_AudioDeviceID); };
+        config.soundCallback = [this]() {
+            // Speculative frames are rerun for real later, don't beep twice. Fast-forward is muted, it would queue
+            // a beep for every few frames
+            if (!m_IsRunningAhead && !isFastForwarding())
+            {
+                playBeep(m_AudioDeviceID);
+            }
+        };
         m_Chip8.setConfig(config);
 
-#ifdef DEBUG
-        (void)argc;
-        (void)argv;
-
-        if (!m_Chip8.loadProgram(ProgramPathPrefix + BuiltinTestPrograms[1]))
+        if (!parseArguments(argc, argv))
         {
-            std::cerr << "Failed to load default program." << std::endl;
+            std::cerr << "Usage: " << argv[0]
+                      << " [--vsync] [--overlay] [--run-ahead <frames>] [--fast-forward <multiplier>]"
+                      << " [--frame-times <file.csv>]"
+                      << " <program_file | --builtin <name>>"
+                      << std::endl;
             return false;
         }
-#else
-        if (argc < 2)
+
+#ifdef DEBUG
+        if (m_Options.programFile.empty() && m_Options.builtinProgram.empty())
         {
-            std::cerr << "Usage: " << argv[0] << " <program_file>" << std::endl;
-            return false;
+            m_Options.builtinProgram = DefaultBuiltinProgram;
         }
+#endif
 
-        const std::string programFile = argv[1];
-        if (!m_Chip8.loadProgram(programFile))
+        if (!m_Options.builtinProgram.empty())
+        {
+            // Builtin programs are embedded in the binary and mapped without copying
+            const std::span<const uint8_t> program = chip8cpp_programs::findProgram(m_Options.builtinProgram);
+            if (program.empty() || !m_Chip8.loadProgramView(program))
+            {
+                std::cerr << "Failed to load builtin program: " << m_Options.builtinProgram << std::endl;
+                std::cerr << "Builtin programs:";
+                for (const chip8cpp_programs::EmbeddedProgram& builtin : chip8cpp_programs::EmbeddedPrograms)
+                {
+                    std::cerr << " " << builtin.name;
+                }
+                std::cerr << std::endl;
+                return false;
+            }
+        }
+        else if (!m_Chip8.loadProgram(m_Options.programFile))
         {
-            std::cerr << "Failed to load program: " << programFile << std::endl;
+            std::cerr << "Failed to load program: " << m_Options.programFile << std::endl;
             return false;
         }
-#endif
 
         // Initialize the SDL2
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
@@ -144,13 +177,34 @@ namespace chip8cpp_app
             return false;
         }
 
-        // Create a window
+        // Precompute the scancode of every Chip8 key once, instead of looking them up every frame.
+        // SDL only knows the keyboard layout once the video subsystem is initialized
+        for (size_t i = 0; i < chip8cpp::constants::KeyCount; ++i)
+        {
+            const auto         keyCode  = static_cast<chip8cpp::KeyCode>(i);
+            const SDL_Scancode scancode = SDL_GetScancodeFromKey(getSDLKeyCode(keyCode));
+            if (scancode == SDL_SCANCODE_UNKNOWN)
+            {
+                std::cerr << "No key for Chip8 key " << chip8cpp::getKeyCodeName(keyCode) << " on this keyboard layout."
+                          << std::endl;
+                continue;
+            }
+            m_ScancodeToKey[scancode] = keyCode;
+        }
+
+        // Create a window, the overlay draws with OpenGL on top of the renderer's output
+        uint32_t windowFlags = SDL_WINDOW_SHOWN;
+        if (m_Options.overlay)
+        {
+            SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
+            windowFlags |= SDL_WINDOW_OPENGL;
+        }
         m_Window = SDL_CreateWindow("Chip8 Interpreter",
                                     SDL_WINDOWPOS_UNDEFINED,
                                     SDL_WINDOWPOS_UNDEFINED,
                                     config.pixelScale * chip8cpp::constants::Width,
                                     config.pixelScale * chip8cpp::constants::Height,
-                                    SDL_WINDOW_SHOWN);
+                                    windowFlags);
 
         // Create a renderer
         if (!m_Window)
@@ -158,7 +212,30 @@ namespace chip8cpp_app
             std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
             return false;
         }
-        m_Renderer = SDL_CreateRenderer(m_Window, -1, SDL_RENDERER_ACCELERATED);
+
+        // Only let presenting wait for the display when its refresh rate matches the 60 Hz the interpreter runs at
+        uint32_t rendererFlags = SDL_RENDERER_ACCELERATED;
+        if (m_Options.vsync)
+        {
+            SDL_DisplayMode displayMode {};
+            if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(m_Window), &displayMode) == 0 &&
+                displayMode.refresh_rate >= 59 && displayMode.refresh_rate <= 61)
+            {
+                rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+                m_FramePacer.setVSync(true);
+            }
+            else
+            {
+                std::cerr << "Display refresh rate is " << displayMode.refresh_rate
+                          << " Hz, pacing frames with the timer instead of vsync." << std::endl;
+            }
+        }
+        m_Renderer = SDL_CreateRenderer(m_Window, -1, rendererFlags);
+
+        if (m_Options.overlay && !m_Overlay.init(m_Window))
+        {
+            std::cerr << "Failed to initialize the overlay, it needs the OpenGL renderer." << std::endl;
+        }
 
         // Initialize audio device for sound output
         SDL_AudioSpec desiredSpec {};
@@ -179,11 +256,9 @@ namespace chip8cpp_app
 
     void App::run()
     {
-        constexpr int targetFPS  = 60;
-        constexpr int frameDelay = 1000 / targetFPS;
-
         while (true)
         {
+            m_FramePacer.beginFrame();
             uint32_t frameStart = SDL_GetTicks();
 
             // Handle events
@@ -192,29 +267,194 @@ namespace chip8cpp_app
             {
                 if (event.type == SDL_QUIT)
                 {
+                    reportStats();
                     return; // Exit the application
                 }
+
+                m_Overlay.processEvent(event);
+
+                if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F1 && event.key.repeat == 0)
+                {
+                    m_Overlay.toggleVisible();
+                }
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F2 && event.key.repeat == 0)
+                {
+                    setFastForward(m_IsFastForwardHeld, !m_IsFastForwardToggled);
+                }
+                else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && event.key.keysym.sym == SDLK_TAB)
+                {
+                    setFastForward(event.type == SDL_KEYDOWN, m_IsFastForwardToggled);
+                }
+                else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && !m_Overlay.wantsKeyboard())
+                {
+                    handleKeyEvent(event.key);
+                }
             }
 
-            // Emulate one cycle of the Chip8 interpreter
-            m_Chip8.emulateOneCycle();
+            // Emulate the Chip8 interpreter for one frame, feeding in the queued key events
+            emulateFrame(frameStart);
+            ++m_EmulatedFrameCount;
+
+            // Fast-forward emulates more frames before presenting this one
+            if (isFastForwarding())
+            {
+                fastForward();
+            }
+
+            // Show a frame from a few frames ahead, so the program's reaction to input appears that much sooner
+            if (m_Options.runAheadFrames > 0)
+            {
+                beginRunAhead();
+            }
+
+            const uint64_t* gfx        = m_Chip8.getGFX();
+            const bool      gfxChanged = std::memcmp(gfx, m_LastGFX, sizeof(m_LastGFX)) != 0;
+            std::memcpy(m_LastGFX, gfx, sizeof(m_LastGFX));
 
-            // If the Chip8 interpreter has a draw flag, render the graphics
-            if (m_Chip8.getDrawFlag())
+            // If the Chip8 interpreter has a draw flag, render the graphics, the overlay is redrawn every frame.
+            // The flag only covers the last instruction, a change in the skipped frames of fast-forward also counts.
+            // With vsync presenting is what paces the frame, so every frame is presented
+            if (m_Chip8.getDrawFlag() || gfxChanged || m_Overlay.isVisible() || m_FramePacer.isVSync())
             {
                 draw();
             }
 
-            // Set key states based on user input
-            setKeyStates();
+            measureInputLatency();
+
+            if (m_Options.runAheadFrames > 0)
+            {
+                endRunAhead();
+            }
+
+            // Show the frame time percentiles about once per second
+            if (m_FramePacer.getFrameCount() % 60 == 0)
+            {
+                updateWindowTitle();
+            }
 
             // Frame rate control to achieve 60 FPS
-            int frameTime = SDL_GetTicks() - frameStart;
-            if (frameDelay > frameTime)
+            m_FramePacer.endFrame();
+        }
+    }
+
+    bool App::parseArguments(int argc, char* argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--vsync")
+            {
+                m_Options.vsync = true;
+            }
+            else if (argument == "--overlay")
+            {
+                m_Options.overlay = true;
+            }
+            else if (argument == "--frame-times" && i + 1 < argc)
+            {
+                m_Options.frameTimesFile = argv[++i];
+            }
+            else if (argument == "--run-ahead" && i + 1 < argc)
+            {
+                const std::string_view frames = argv[++i];
+                const auto [end, error] =
+                    std::from_chars(frames.data(), frames.data() + frames.size(), m_Options.runAheadFrames);
+                if (error != std::errc {} || end != frames.data() + frames.size() ||
+                    m_Options.runAheadFrames > MaxRunAheadFrames)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--fast-forward" && i + 1 < argc)
             {
-                SDL_Delay(frameDelay - frameTime);
+                const std::string_view multiplier = argv[++i];
+                const auto [end, error]           = std::from_chars(
+                    multiplier.data(), multiplier.data() + multiplier.size(), m_Options.fastForwardMultiplier);
+                if (error != std::errc {} || end != multiplier.data() + multiplier.size() ||
+                    m_Options.fastForwardMultiplier < 2 || m_Options.fastForwardMultiplier > MaxFastForwardMultiplier)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--builtin" && i + 1 < argc && m_Options.programFile.empty())
+            {
+                m_Options.builtinProgram = argv[++i];
+            }
+            else if (argument.starts_with("--") || !m_Options.programFile.empty() || !m_Options.builtinProgram.empty())
+            {
+                return false; // Unknown option or more than one program
+            }
+            else
+            {
+                m_Options.programFile = argument;
             }
         }
+
+#ifdef DEBUG
+        return true; // A builtin test program is loaded when none is given
+#else
+        return !m_Options.programFile.empty() || !m_Options.builtinProgram.empty();
+#endif
+    }
+
+    void App::reportStats()
+    {
+        if (m_InputLatency.sampleCount > 0)
+        {
+            std::cout << "Input-to-photon latency: " << m_InputLatency.sampleCount << " samples, avg "
+                      << m_InputLatency.totalMs / m_InputLatency.sampleCount << " ms, max " << m_InputLatency.maxMs
+                      << " ms" << std::endl;
+        }
+
+        if (m_RunAheadStats.frameCount > 0)
+        {
+            std::cout << std::format("Run-ahead of {} frames: avg {:.1f} us, max {:.1f} us of CPU time per frame",
+                                     m_Options.runAheadFrames,
+                                     m_RunAheadStats.totalUs / m_RunAheadStats.frameCount,
+                                     m_RunAheadStats.maxUs)
+                      << std::endl;
+        }
+
+        const FrameTimeStats frameTimes = m_FramePacer.getStats();
+        if (frameTimes.sampleCount > 0)
+        {
+            std::cout << std::format("Frame time over the last {} frames: p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms",
+                                     frameTimes.sampleCount,
+                                     frameTimes.p50Ms,
+                                     frameTimes.p99Ms,
+                                     frameTimes.maxMs)
+                      << std::endl;
+        }
+
+        if (!m_Options.frameTimesFile.empty() && !m_FramePacer.exportFrameTimes(m_Options.frameTimesFile))
+        {
+            std::cerr << "Failed to export frame times to: " << m_Options.frameTimesFile << std::endl;
+        }
+    }
+
+    void App::updateWindowTitle()
+    {
+        // Emulated speed since the last update, 1.0x is one emulated frame per frame period
+        const FramePacer::Clock::time_point now   = FramePacer::Clock::now();
+        double                              speed = 1.0;
+        if (m_TitleUpdateTime != FramePacer::Clock::time_point {})
+        {
+            const std::chrono::duration<double> elapsed = now - m_TitleUpdateTime;
+            const std::chrono::duration<double> period  = m_FramePacer.getFramePeriod();
+            speed = m_EmulatedFrameCount * period.count() / elapsed.count();
+        }
+        m_EmulatedFrameCount = 0;
+        m_TitleUpdateTime    = now;
+
+        const FrameTimeStats frameTimes = m_FramePacer.getStats();
+        const std::string    title =
+            std::format("Chip8 Interpreter - {:.1f}x{} - p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms",
+                        speed,
+                        isFastForwarding() ? " fast-forward" : "",
+                        frameTimes.p50Ms,
+                        frameTimes.p99Ms,
+                        frameTimes.maxMs);
+        SDL_SetWindowTitle(m_Window, title.c_str());
     }
 
     void App::draw()
@@ -226,13 +466,11 @@ namespace chip8cpp_app
         SDL_RenderClear(m_Renderer);
 
         // Render the graphics buffer (m_GFX) to the SDL window
-        const uint8_t* gfx = m_Chip8.getGFX();
         for (size_t y = 0; y < chip8cpp::constants::Height; ++y)
         {
             for (size_t x = 0; x < chip8cpp::constants::Width; ++x)
             {
-                size_t index = x + y * chip8cpp::constants::Width;
-                if (gfx[index] == 1) // Pixel is on
+                if (m_Chip8.getPixel(x, y)) // Pixel is on
                 {
                     const int scale = m_Chip8.getConfig().pixelScale;
                     SDL_Rect  rect  = {static_cast<int>(x * scale), static_cast<int>(y * scale), scale, scale};
@@ -260,18 +498,190 @@ namespace chip8cpp_app
             }
         }
 
+        // Draw the overlay from a snapshot, after the renderer has submitted the display
+        if (m_Overlay.isVisible())
+        {
+            m_Chip8.captureSnapshot(m_Snapshot);
+            SDL_RenderFlush(m_Renderer);
+            m_Overlay.render(m_Snapshot, m_PCHeatmap, m_FramePacer, m_InstructionCount, m_CyclesPerFrame);
+        }
+
         SDL_RenderPresent(m_Renderer);
     }
 
-    void App::setKeyStates()
+    void App::handleKeyEvent(const SDL_KeyboardEvent& keyEvent)
+    {
+        if (keyEvent.repeat != 0)
+        {
+            return; // The key state did not change
+        }
+
+        const std::optional<chip8cpp::KeyCode> keyCode = m_ScancodeToKey[keyEvent.keysym.scancode];
+        if (keyCode)
+        {
+            m_InputEvents.push_back({keyEvent.timestamp, *keyCode, keyEvent.type == SDL_KEYDOWN});
+        }
+    }
+
+    void App::emulateFrame(uint32_t frameStart)
+    {
+        // The instructions of a frame stand for equal slices of the time since the previous frame, each one running
+        // at the end of its slice, so a key event reaches the core at the first instruction boundary after it happened
+        const uint32_t frameInterval = frameStart - m_LastFrameStart;
+
+        // Start a latency measurement at the first key press of the frame, unless an earlier one is still waiting to
+        // show up. The state before the frame is where the run without the key starts.
+        if (!m_PendingInput)
+        {
+            const auto press = std::ranges::find_if(m_InputEvents,
+                                                    [frameStart](const InputEvent& event)
+                                                    { return event.isPressed && event.timestamp <= frameStart; });
+            if (press != m_InputEvents.end())
+            {
+                m_PendingInput = *press;
+                m_Chip8.saveCheckpoint(m_LatencyCheckpoint);
+            }
+        }
+
+        for (uint32_t i = 0; i < m_CyclesPerFrame; ++i)
+        {
+            applyInputEvents(m_LastFrameStart + frameInterval * (i + 1) / m_CyclesPerFrame);
+            if (m_Overlay.isVisible())
+            {
+                ++m_PCHeatmap[m_Chip8.getPC() % chip8cpp::constants::MemorySize];
+            }
+            m_Chip8.emulateOneCycle();
+        }
+        m_InstructionCount += m_CyclesPerFrame;
+        m_LastFrameStart = frameStart;
+    }
+
+    void App::applyInputEvents(uint32_t until)
+    {
+        auto it = m_InputEvents.begin();
+        for (; it != m_InputEvents.end() && it->timestamp <= until; ++it)
+        {
+            m_Chip8.setKeyState(it->keyCode, it->isPressed);
+        }
+        m_InputEvents.erase(m_InputEvents.begin(), it);
+    }
+
+    void App::beginRunAhead()
+    {
+        const FramePacer::Clock::time_point start = FramePacer::Clock::now();
+
+        // Keep the current keys held for every speculative frame
+        m_Chip8.saveCheckpoint(m_RunAheadCheckpoint);
+        m_IsRunningAhead = true;
+        for (uint32_t i = 0; i < m_Options.runAheadFrames * m_CyclesPerFrame; ++i)
+        {
+            m_Chip8.emulateOneCycle();
+        }
+        m_IsRunningAhead = false;
+
+        m_RunAheadTime = FramePacer::Clock::now() - start;
+    }
+
+    void App::endRunAhead()
+    {
+        const FramePacer::Clock::time_point start = FramePacer::Clock::now();
+
+        // Back to the real state, the next frame continues from there
+        m_Chip8.restoreCheckpoint(m_RunAheadCheckpoint);
+
+        m_RunAheadTime += FramePacer::Clock::now() - start;
+
+        const double timeUs = std::chrono::duration<double, std::micro>(m_RunAheadTime).count();
+        ++m_RunAheadStats.frameCount;
+        m_RunAheadStats.totalUs += timeUs;
+        m_RunAheadStats.maxUs = std::max(m_RunAheadStats.maxUs, timeUs);
+    }
+
+    bool App::isFastForwarding() const { return m_IsFastForwardHeld || m_IsFastForwardToggled; }
+
+    void App::setFastForward(bool isHeld, bool isToggled)
+    {
+        const bool wasFastForwarding = isFastForwarding();
+        m_IsFastForwardHeld          = isHeld;
+        m_IsFastForwardToggled       = isToggled;
+
+        if (!wasFastForwarding && isFastForwarding())
+        {
+            SDL_ClearQueuedAudio(m_AudioDeviceID); // Cut a playing beep short, fast-forward is muted
+        }
+    }
+
+    void App::fastForward()
+    {
+        // The extra frames skip the per instruction input timing and PC heatmap of emulateFrame(), they run in one
+        // call, so compiled programs stay in native code. Key changes apply from the next presented frame.
+        uint32_t frameCount = 0;
+        if (m_IsFastForwardHeld)
+        {
+            // Unthrottled, emulate until the frame is almost over, so frames are still presented at the pacer's rate
+            const FramePacer::Clock::time_point end =
+                m_FramePacer.getFrameStart() + m_FramePacer.getFramePeriod() - FastForwardPresentTime;
+            while (FramePacer::Clock::now() < end)
+            {
+                m_Chip8.emulateCycles(FastForwardBatchFrames * m_CyclesPerFrame);
+                frameCount += FastForwardBatchFrames;
+            }
+        }
+        else
+        {
+            // Present every Nth frame, the one emulateFrame() just ran is the last of them
+            frameCount = m_Options.fastForwardMultiplier - 1;
+            m_Chip8.emulateCycles(frameCount * m_CyclesPerFrame);
+        }
+
+        m_InstructionCount += static_cast<uint64_t>(frameCount) * m_CyclesPerFrame;
+        m_EmulatedFrameCount += frameCount;
+
+        m_PendingInput.reset(); // The run without the key only follows presented frames
+    }
+
+    void App::measureInputLatency()
     {
-        // Set key states based on user input
-        const uint8_t* state = SDL_GetKeyboardState(nullptr);
+        if (!m_PendingInput)
+        {
+            return;
+        }
+
+        const uint32_t latency = SDL_GetTicks() - m_PendingInput->timestamp;
+
+        // Many programs animate every frame, so a change on screen only counts when it differs from the same frames
+        // run without the key press. The other keys are held as they are now.
+        uint32_t heldKeys = 0;
         for (size_t i = 0; i < chip8cpp::constants::KeyCount; ++i)
         {
-            chip8cpp::KeyCode keyCode   = static_cast<chip8cpp::KeyCode>(i);
-            bool              isPressed = state[SDL_GetScancodeFromKey(getSDLKeyCode(keyCode))] != 0;
-            m_Chip8.setKeyState(keyCode, isPressed);
+            heldKeys |= m_Chip8.isKeyPressed(static_cast<chip8cpp::KeyCode>(i)) ? 1u << i : 0u;
+        }
+
+        m_Chip8.saveCheckpoint(m_LatencyShownCheckpoint);
+        m_Chip8.restoreCheckpoint(m_LatencyCheckpoint);
+        m_IsRunningAhead = true;
+        for (size_t i = 0; i < chip8cpp::constants::KeyCount; ++i)
+        {
+            const auto keyCode = static_cast<chip8cpp::KeyCode>(i);
+            m_Chip8.setKeyState(keyCode, keyCode != m_PendingInput->keyCode && (heldKeys & (1u << i)) != 0);
+        }
+        m_Chip8.emulateCycles(m_CyclesPerFrame);
+        m_Chip8.saveCheckpoint(m_LatencyCheckpoint);
+        m_Chip8.emulateCycles(m_Options.runAheadFrames * m_CyclesPerFrame); // As far ahead as the frame shown
+        const bool isReaction = std::memcmp(m_Chip8.getGFX(), m_LastGFX, sizeof(m_LastGFX)) != 0;
+        m_IsRunningAhead      = false;
+        m_Chip8.restoreCheckpoint(m_LatencyShownCheckpoint);
+
+        if (isReaction)
+        {
+            ++m_InputLatency.sampleCount;
+            m_InputLatency.totalMs += latency;
+            m_InputLatency.maxMs = std::max(m_InputLatency.maxMs, latency);
+            m_PendingInput.reset();
+        }
+        else if (latency > InputLatencyTimeoutMs)
+        {
+            m_PendingInput.reset(); // The key press had no visible effect
         }
     }
 } // namespace chip8cpp_app
\ No newline at end of file
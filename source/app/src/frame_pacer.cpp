@@ -0,0 +1,130 @@
+#include <chip8cpp_app/frame_pacer.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr std::chrono::microseconds MinSpinWindow {250};  // Shortest spin before a deadline
+    constexpr std::chrono::microseconds MaxSpinWindow {4000}; // Longest spin before a deadline
+} // namespace
+
+namespace chip8cpp_app
+{
+    FramePacer::FramePacer(double targetFPS) :
+        m_FramePeriod(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFPS)))
+    {
+        assert(targetFPS > 0.0);
+    }
+
+    void FramePacer::setVSync(bool enabled) { m_VSync = enabled; }
+    bool FramePacer::isVSync() const { return m_VSync; }
+
+    void FramePacer::beginFrame()
+    {
+        const Clock::time_point now = Clock::now();
+        if (m_FrameStart == Clock::time_point {})
+        {
+            m_NextDeadline = now; // First frame, start the deadline schedule here
+        }
+        else
+        {
+            const std::chrono::duration<float, std::milli> frameTime = now - m_FrameStart;
+            m_FrameTimesMs[m_FrameCount % HistorySize]               = frameTime.count();
+            ++m_FrameCount;
+        }
+        m_FrameStart = now;
+    }
+
+    void FramePacer::endFrame()
+    {
+        if (m_VSync)
+        {
+            return; // Presenting already waited for the display refresh
+        }
+
+        // Deadlines advance by exactly one period, so a late frame is made up by the next one instead of drifting
+        m_NextDeadline += m_FramePeriod;
+
+        const Clock::time_point now = Clock::now();
+        if (now > m_NextDeadline + m_FramePeriod)
+        {
+            m_NextDeadline = now; // More than a frame behind, drop the backlog instead of rushing frames
+            return;
+        }
+
+        waitUntil(m_NextDeadline);
+    }
+
+    FramePacer::Clock::time_point FramePacer::getFrameStart() const { return m_FrameStart; }
+    FramePacer::Clock::duration   FramePacer::getFramePeriod() const { return m_FramePeriod; }
+
+    size_t FramePacer::getFrameCount() const { return m_FrameCount; }
+
+    FrameTimeStats FramePacer::getStats() const
+    {
+        FrameTimeStats stats {};
+        stats.sampleCount = std::min(m_FrameCount, HistorySize);
+        if (stats.sampleCount == 0)
+        {
+            return stats;
+        }
+
+        std::vector<float> samples(m_FrameTimesMs.begin(), m_FrameTimesMs.begin() + stats.sampleCount);
+        std::ranges::sort(samples);
+        stats.p50Ms = samples[stats.sampleCount / 2];
+        stats.p99Ms = samples[std::min(stats.sampleCount - 1, stats.sampleCount * 99 / 100)];
+        stats.maxMs = samples.back();
+        return stats;
+    }
+
+    float FramePacer::getFrameTimeMs(size_t framesAgo) const
+    {
+        if (framesAgo >= std::min(m_FrameCount, HistorySize))
+        {
+            return 0.0f;
+        }
+        return m_FrameTimesMs[(m_FrameCount - 1 - framesAgo) % HistorySize];
+    }
+
+    bool FramePacer::exportFrameTimes(const std::string& fileName) const
+    {
+        std::ofstream file(fileName);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        // Oldest frame first
+        const size_t sampleCount = std::min(m_FrameCount, HistorySize);
+        file << "frame,frame_time_ms\n";
+        for (size_t i = 0; i < sampleCount; ++i)
+        {
+            file << m_FrameCount - sampleCount + i << ',' << getFrameTimeMs(sampleCount - 1 - i) << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+
+    void FramePacer::waitUntil(Clock::time_point deadline)
+    {
+        // Sleep through most of the wait, then spin for the last stretch that sleeping cannot hit precisely
+        const Clock::time_point sleepUntil = deadline - m_SpinWindow;
+        if (Clock::now() < sleepUntil)
+        {
+            std::this_thread::sleep_until(sleepUntil);
+
+            // Settle the spin window at about twice the observed oversleep
+            const Clock::duration overshoot = Clock::now() - sleepUntil;
+            m_SpinWindow                    = std::clamp<Clock::duration>(
+                (m_SpinWindow * 7 + overshoot * 2) / 8, MinSpinWindow, MaxSpinWindow);
+        }
+
+        while (Clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+} // namespace chip8cpp_app
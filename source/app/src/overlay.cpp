@@ -0,0 +1,238 @@
+#include <chip8cpp_app/overlay.hpp>
+
+#include <imgui.h>
+#include <imgui_impl_opengl3.h>
+#include <imgui_impl_sdl2.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr size_t FrameGraphLength  = 240;  // Frames shown in the frame time graph
+    constexpr int    HeatmapColumns    = 64;   // Addresses per heatmap row
+    constexpr float  HeatmapCellSize   = 5.0f; // Size of a heatmap cell in pixels
+    constexpr int    MemoryViewerWidth = 16;   // Bytes per memory viewer row
+    constexpr int    MaxCyclesPerFrame = 1000; // Upper bound of the cycles per frame slider
+    constexpr double RateSampleSeconds = 0.5;  // Interval between instructions/sec samples
+} // namespace
+
+namespace chip8cpp_app
+{
+    Overlay::~Overlay()
+    {
+        if (m_Initialized)
+        {
+            ImGui_ImplOpenGL3_Shutdown();
+            ImGui_ImplSDL2_Shutdown();
+            ImGui::DestroyContext();
+        }
+    }
+
+    bool Overlay::init(SDL_Window* window)
+    {
+        // Draw with the GL context of the SDL renderer, which is current after the renderer is created
+        SDL_GLContext glContext = SDL_GL_GetCurrentContext();
+        if (!glContext)
+        {
+            return false; // The renderer does not use OpenGL
+        }
+
+        ImGui::CreateContext();
+        ImGui::StyleColorsDark();
+        ImGui::GetIO().IniFilename = nullptr; // Don't write imgui.ini next to the binary
+
+        if (!ImGui_ImplSDL2_InitForOpenGL(window, glContext) || !ImGui_ImplOpenGL3_Init("#version 130"))
+        {
+            ImGui::DestroyContext();
+            return false;
+        }
+
+        m_Initialized    = true;
+        m_RateSampleTime = Clock::now();
+        return true;
+    }
+
+    void Overlay::processEvent(const SDL_Event& event)
+    {
+        if (m_Initialized)
+        {
+            ImGui_ImplSDL2_ProcessEvent(&event);
+        }
+    }
+
+    bool Overlay::isVisible() const { return m_Initialized && m_Visible; }
+    void Overlay::toggleVisible() { m_Visible = !m_Visible; }
+    bool Overlay::wantsKeyboard() const { return isVisible() && ImGui::GetIO().WantCaptureKeyboard; }
+
+    void Overlay::render(const chip8cpp::Snapshot& snapshot,
+                         const PCHeatmap&          pcHeatmap,
+                         const FramePacer&         framePacer,
+                         uint64_t                  instructionCount,
+                         uint32_t&                 cyclesPerFrame)
+    {
+        if (!isVisible())
+        {
+            return;
+        }
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplSDL2_NewFrame();
+        ImGui::NewFrame();
+
+        drawPerformanceWindow(framePacer, instructionCount, cyclesPerFrame);
+        drawMachineWindow(snapshot);
+        drawHeatmapWindow(pcHeatmap);
+        drawMemoryWindow(snapshot);
+
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
+
+    void Overlay::drawPerformanceWindow(const FramePacer& framePacer,
+                                        uint64_t          instructionCount,
+                                        uint32_t&         cyclesPerFrame)
+    {
+        // Sample the instruction rate over a short interval so the number is readable
+        const Clock::time_point             now     = Clock::now();
+        const std::chrono::duration<double> elapsed = now - m_RateSampleTime;
+        if (elapsed.count() >= RateSampleSeconds)
+        {
+            m_InstructionsPerSec = (instructionCount - m_RateSampleCount) / elapsed.count();
+            m_RateSampleTime     = now;
+            m_RateSampleCount    = instructionCount;
+        }
+
+        ImGui::Begin("Performance");
+
+        ImGui::Text("Instructions/sec: %.0f", m_InstructionsPerSec);
+
+        const FrameTimeStats frameTimes = framePacer.getStats();
+        ImGui::Text("Frame time: p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+                    frameTimes.p50Ms,
+                    frameTimes.p99Ms,
+                    frameTimes.maxMs);
+
+        // Oldest frame on the left
+        float frameGraph[FrameGraphLength] {};
+        for (size_t i = 0; i < FrameGraphLength; ++i)
+        {
+            frameGraph[i] = framePacer.getFrameTimeMs(FrameGraphLength - 1 - i);
+        }
+        ImGui::PlotLines("Frame time (ms)",
+                         frameGraph,
+                         static_cast<int>(FrameGraphLength),
+                         0,
+                         nullptr,
+                         0.0f,
+                         std::max(33.3f, static_cast<float>(frameTimes.maxMs)),
+                         ImVec2(0.0f, 80.0f));
+
+        int cycles = static_cast<int>(cyclesPerFrame);
+        if (ImGui::SliderInt("Cycles per frame", &cycles, 1, MaxCyclesPerFrame))
+        {
+            cyclesPerFrame = static_cast<uint32_t>(cycles);
+        }
+
+        ImGui::End();
+    }
+
+    void Overlay::drawMachineWindow(const chip8cpp::Snapshot& snapshot)
+    {
+        ImGui::Begin("Machine");
+
+        ImGui::Text("PC: 0x%03X  I: 0x%03X  SP: %u", snapshot.PC, snapshot.I, snapshot.SP);
+        ImGui::Text("DT: %3u  ST: %3u", snapshot.delayTimer, snapshot.soundTimer);
+
+        ImGui::SeparatorText("Registers");
+        for (size_t i = 0; i < chip8cpp::constants::RegisterCount; ++i)
+        {
+            ImGui::Text("V%X: 0x%02X", static_cast<unsigned>(i), snapshot.V[i]);
+            if (i % 4 != 3)
+            {
+                ImGui::SameLine();
+            }
+        }
+
+        ImGui::SeparatorText("Stack");
+        for (size_t i = 0; i < snapshot.SP && i < chip8cpp::constants::StackSize; ++i)
+        {
+            ImGui::Text("%2u: 0x%03X", static_cast<unsigned>(i), snapshot.stack[i]);
+        }
+
+        ImGui::SeparatorText("Keys");
+        for (size_t i = 0; i < chip8cpp::constants::KeyCount; ++i)
+        {
+            ImGui::Text(snapshot.keys[i] ? "[%X]" : " %X ", static_cast<unsigned>(i));
+            if (i % 8 != 7)
+            {
+                ImGui::SameLine();
+            }
+        }
+
+        ImGui::End();
+    }
+
+    void Overlay::drawHeatmapWindow(const PCHeatmap& pcHeatmap)
+    {
+        ImGui::Begin("PC heatmap");
+
+        // Log scale, so rarely executed code stays visible next to the hottest loop
+        const uint32_t hottest  = *std::ranges::max_element(pcHeatmap);
+        const float    logScale = hottest > 0 ? 1.0f / std::log1p(static_cast<float>(hottest)) : 0.0f;
+
+        ImDrawList*  drawList = ImGui::GetWindowDrawList();
+        const ImVec2 origin   = ImGui::GetCursorScreenPos();
+        for (size_t address = 0; address < pcHeatmap.size(); ++address)
+        {
+            if (pcHeatmap[address] == 0)
+            {
+                continue;
+            }
+
+            const float  heat   = std::log1p(static_cast<float>(pcHeatmap[address])) * logScale;
+            const ImVec2 minPos = {origin.x + (address % HeatmapColumns) * HeatmapCellSize,
+                                   origin.y + (address / HeatmapColumns) * HeatmapCellSize};
+            const ImVec2 maxPos = {minPos.x + HeatmapCellSize, minPos.y + HeatmapCellSize};
+            drawList->AddRectFilled(minPos, maxPos, ImGui::GetColorU32(ImVec4(heat, 0.2f, 1.0f - heat, 1.0f)));
+        }
+
+        const int rows = static_cast<int>(pcHeatmap.size()) / HeatmapColumns;
+        ImGui::Dummy(ImVec2(HeatmapColumns * HeatmapCellSize, rows * HeatmapCellSize));
+        ImGui::Text("One cell per address, 0x000 at the top left, %d addresses per row", HeatmapColumns);
+
+        ImGui::End();
+    }
+
+    void Overlay::drawMemoryWindow(const chip8cpp::Snapshot& snapshot)
+    {
+        ImGui::Begin("Memory");
+
+        // Only format the rows that are on screen
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(chip8cpp::constants::MemorySize) / MemoryViewerWidth);
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+            {
+                const int address = row * MemoryViewerWidth;
+                ImGui::Text("0x%03X:", address);
+                for (int i = 0; i < MemoryViewerWidth; ++i)
+                {
+                    ImGui::SameLine();
+                    const bool isPC = address + i == snapshot.PC || address + i == snapshot.PC + 1;
+                    if (isPC)
+                    {
+                        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%02X", snapshot.memory[address + i]);
+                    }
+                    else
+                    {
+                        ImGui::Text("%02X", snapshot.memory[address + i]);
+                    }
+                }
+            }
+        }
+
+        ImGui::End();
+    }
+} // namespace chip8cpp_app
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chip8cpp_batch
+{
+    // Command line options
+    struct BatchOptions
+    {
+        std::vector<std::string> inputs;             // Program files and directories to search for .ch8 files
+        std::string              listFile;           // Text file with one program path per line
+        uint32_t                 frameCount {600};   // Frames to run each program for, 10 seconds at 60 FPS
+        uint32_t                 cyclesPerFrame {1}; // Instructions run per frame
+        uint32_t                 threadCount {0};    // Worker threads, 0 for one per core
+        uint32_t                 randomSeed {1};     // CXNN seed of every program, so results repeat between runs
+    };
+
+    // Why a program stopped running
+    enum class StopReason : uint8_t
+    {
+        eFrameLimit, // Ran for all frames
+        eHalt,       // Jumps to itself
+        eKeyWait,    // Waits for a key, none is ever pressed
+        eTrap,       // Stopped on a trap
+        eLoadFailed, // Could not be loaded
+    };
+
+    // Outcome of running one program
+    struct BatchResult
+    {
+        StopReason     stopReason {StopReason::eFrameLimit}; // Why the program stopped
+        chip8cpp::Trap trap {};                              // Trap it stopped on, if any
+        uint16_t       PC {0};                               // Address the program stopped at
+        uint32_t       frameCount {0};                       // Frames run
+        uint64_t       instructionCount {0};                 // Instructions run, not counting retries of a trap
+        double         seconds {0.0};                        // Time spent running
+        uint64_t       framebufferHash {0};                  // FNV-1a hash of the final graphics buffer rows
+        bool           isDone {false};                       // Whether the result can be written
+    };
+
+    // Runs a corpus of programs headless and unthrottled, one program per thread at a time, and writes one JSON
+    // line per program in input order. Threads take the next program from a shared index, so a few slow programs
+    // don't leave the other threads idle.
+    class BatchRunner
+    {
+    public:
+        BatchRunner()  = default;
+        ~BatchRunner() = default;
+
+        bool init(int argc, char* argv[]);
+        void run();
+
+    private:
+        bool parseArguments(int argc, char* argv[]);
+        bool collectPrograms();
+
+        void        runPrograms();
+        BatchResult runProgram(chip8cpp::Chip8& chip8, const std::string& programFile) const;
+        void        writeResults(size_t index, const BatchResult& result);
+
+    private:
+        BatchOptions             m_Options;              // Command line options
+        std::vector<std::string> m_Programs;             // Program files in output order
+        std::vector<BatchResult> m_Results;              // Results, written once all earlier ones are
+        std::atomic<size_t>      m_NextProgram {0};      // Next program to hand out
+        size_t                   m_NextOutput {0};       // Next result to write
+        uint64_t                 m_InstructionCount {0}; // Instructions run by all programs
+        std::mutex               m_OutputMutex;          // Guards the results and the output
+    };
+} // namespace chip8cpp_batch
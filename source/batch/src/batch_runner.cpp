@@ -0,0 +1,354 @@
+#include <chip8cpp_batch/batch_runner.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // Upper bound of --cycles
+    constexpr uint32_t MaxCyclesPerFrame = 1000;
+
+    constexpr uint64_t FNVOffsetBasis = 0xCBF29CE484222325;
+    constexpr uint64_t FNVPrime       = 0x100000001B3;
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& value)
+    {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc {} && end == text.data() + text.size();
+    }
+
+    // Hashes the rows as big-endian bytes, so the hash doesn't depend on the host
+    uint64_t hashFramebuffer(const uint64_t* gfx)
+    {
+        uint64_t hash = FNVOffsetBasis;
+        for (size_t y = 0; y < chip8cpp::constants::Height; ++y)
+        {
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                hash = (hash ^ ((gfx[y] >> shift) & 0xFF)) * FNVPrime;
+            }
+        }
+        return hash;
+    }
+
+    const char* getStopReasonName(chip8cpp_batch::StopReason stopReason)
+    {
+        switch (stopReason)
+        {
+            case chip8cpp_batch::StopReason::eFrameLimit:
+                return "frame limit";
+            case chip8cpp_batch::StopReason::eHalt:
+                return "halt";
+            case chip8cpp_batch::StopReason::eKeyWait:
+                return "key wait";
+            case chip8cpp_batch::StopReason::eTrap:
+                return "trap";
+            case chip8cpp_batch::StopReason::eLoadFailed:
+                return "load failed";
+        }
+        return "";
+    }
+
+    std::string escapeJSON(std::string_view text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                escaped += std::format("\\u{:04x}", static_cast<unsigned int>(c));
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+} // namespace
+
+namespace chip8cpp_batch
+{
+    bool BatchRunner::init(int argc, char* argv[])
+    {
+        if (!parseArguments(argc, argv))
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--frames <count>] [--cycles <per frame>] [--threads <count>] [--seed <value>]"
+                         " [--list <file>] [program_file | directory]..."
+                      << std::endl;
+            return false;
+        }
+
+        if (!collectPrograms())
+        {
+            return false;
+        }
+
+        if (m_Options.threadCount == 0)
+        {
+            m_Options.threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        m_Options.threadCount = std::min<uint32_t>(m_Options.threadCount, std::max<size_t>(m_Programs.size(), 1));
+
+        m_Results.resize(m_Programs.size());
+        return true;
+    }
+
+    void BatchRunner::run()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // The calling thread runs programs too
+        std::vector<std::thread> workers;
+        for (uint32_t i = 1; i < m_Options.threadCount; ++i)
+        {
+            workers.emplace_back([this]() { runPrograms(); });
+        }
+        runPrograms();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << std::format("{} programs in {:.2f} s on {} threads, {:.0f} instructions/s\n",
+                                 m_Programs.size(),
+                                 elapsed.count(),
+                                 m_Options.threadCount,
+                                 m_InstructionCount / elapsed.count());
+    }
+
+    bool BatchRunner::parseArguments(int argc, char* argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--frames" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.frameCount) || m_Options.frameCount == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--cycles" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.cyclesPerFrame) || m_Options.cyclesPerFrame == 0 ||
+                    m_Options.cyclesPerFrame > MaxCyclesPerFrame)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--threads" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.threadCount))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--seed" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.randomSeed))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--list" && i + 1 < argc)
+            {
+                m_Options.listFile = argv[++i];
+            }
+            else if (argument.starts_with("--"))
+            {
+                return false; // Unknown option
+            }
+            else
+            {
+                m_Options.inputs.push_back(argument);
+            }
+        }
+
+        return !m_Options.inputs.empty() || !m_Options.listFile.empty();
+    }
+
+    bool BatchRunner::collectPrograms()
+    {
+        if (!m_Options.listFile.empty())
+        {
+            std::ifstream list(m_Options.listFile);
+            if (!list.is_open())
+            {
+                std::cerr << "Failed to open program list: " << m_Options.listFile << std::endl;
+                return false;
+            }
+
+            std::string line;
+            while (std::getline(list, line))
+            {
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                if (!line.empty())
+                {
+                    m_Programs.push_back(line);
+                }
+            }
+        }
+
+        // Directories are searched recursively, their programs are run in path order so the output is stable
+        for (const std::string& input : m_Options.inputs)
+        {
+            std::error_code error;
+            if (!std::filesystem::is_directory(input, error))
+            {
+                m_Programs.push_back(input); // A missing file is reported in its result
+                continue;
+            }
+
+            std::vector<std::string> directoryPrograms;
+            for (const std::filesystem::directory_entry& entry :
+                 std::filesystem::recursive_directory_iterator(input, error))
+            {
+                std::string extension = entry.path().extension().string();
+                std::ranges::transform(extension,
+                                       extension.begin(),
+                                       [](char c)
+                                       { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+                if (entry.is_regular_file(error) && extension == ".ch8")
+                {
+                    directoryPrograms.push_back(entry.path().string());
+                }
+            }
+            if (error)
+            {
+                std::cerr << "Failed to read directory: " << input << " (" << error.message() << ")" << std::endl;
+                return false;
+            }
+
+            std::ranges::sort(directoryPrograms);
+            m_Programs.insert(m_Programs.end(), directoryPrograms.begin(), directoryPrograms.end());
+        }
+
+        return true;
+    }
+
+    void BatchRunner::runPrograms()
+    {
+        // One interpreter per thread, reloaded for every program
+        chip8cpp::Config config {};
+        config.printTraps = false; // Traps are written to the results
+#ifdef DEBUG
+        config.printKeyStates = false;
+#endif
+        chip8cpp::Chip8 chip8(config);
+
+        size_t index = 0;
+        while ((index = m_NextProgram.fetch_add(1, std::memory_order_relaxed)) < m_Programs.size())
+        {
+            writeResults(index, runProgram(chip8, m_Programs[index]));
+        }
+    }
+
+    BatchResult BatchRunner::runProgram(chip8cpp::Chip8& chip8, const std::string& programFile) const
+    {
+        BatchResult result {};
+        if (!chip8.loadProgram(programFile))
+        {
+            result.stopReason = StopReason::eLoadFailed;
+            return result;
+        }
+
+        // Loading seeds CXNN from the system, a fixed seed makes the framebuffer hash comparable between runs
+        chip8.setRandomSeed(m_Options.randomSeed);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        // Check for the end of the program once per frame, halting costs at most one frame of instructions
+        while (result.frameCount < m_Options.frameCount)
+        {
+            result.instructionCount += chip8.emulateCycles(m_Options.cyclesPerFrame);
+            ++result.frameCount;
+
+            const uint16_t PC     = chip8.getPC();
+            const uint16_t opcode = static_cast<uint16_t>(chip8.readMemory(PC) << 8 | chip8.readMemory(PC + 1));
+            if (chip8.getTrap() != chip8cpp::Trap::eNone)
+            {
+                result.stopReason = StopReason::eTrap;
+                break;
+            }
+            if (opcode == (0x1000 | PC))
+            {
+                result.stopReason = StopReason::eHalt;
+                break;
+            }
+            if ((opcode & 0xF0FF) == 0xF00A)
+            {
+                result.stopReason = StopReason::eKeyWait; // No keys are pressed in batch runs
+                break;
+            }
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        result.trap             = chip8.getTrap();
+        result.PC               = chip8.getPC();
+        result.seconds          = elapsed.count();
+        result.framebufferHash  = hashFramebuffer(chip8.getGFX());
+        return result;
+    }
+
+    void BatchRunner::writeResults(size_t index, const BatchResult& result)
+    {
+        const std::lock_guard lock(m_OutputMutex);
+
+        m_Results[index]        = result;
+        m_Results[index].isDone = true;
+        m_InstructionCount += result.instructionCount;
+
+        // Write every finished result up to the first one still running, so lines come out in input order
+        std::string lines;
+        for (; m_NextOutput < m_Results.size() && m_Results[m_NextOutput].isDone; ++m_NextOutput)
+        {
+            const BatchResult& done = m_Results[m_NextOutput];
+            if (done.stopReason == StopReason::eLoadFailed)
+            {
+                lines += std::format("{{\"program\":\"{}\",\"stop\":\"{}\"}}\n",
+                                     escapeJSON(m_Programs[m_NextOutput]),
+                                     getStopReasonName(done.stopReason));
+                continue;
+            }
+
+            const std::string trap =
+                done.trap == chip8cpp::Trap::eNone ? "null" : std::format("\"{}\"", chip8cpp::getTrapName(done.trap));
+            lines += std::format("{{\"program\":\"{}\",\"stop\":\"{}\",\"trap\":{},\"pc\":{},\"frames\":{},"
+                                 "\"instructions\":{},\"instructions_per_sec\":{:.0f},\"framebuffer_hash\":\"{:016x}\"}}\n",
+                                 escapeJSON(m_Programs[m_NextOutput]),
+                                 getStopReasonName(done.stopReason),
+                                 trap,
+                                 done.PC,
+                                 done.frameCount,
+                                 done.instructionCount,
+                                 done.seconds > 0.0 ? done.instructionCount / done.seconds : 0.0,
+                                 done.framebufferHash);
+        }
+
+        if (!lines.empty())
+        {
+            std::cout << lines << std::flush;
+        }
+    }
+} // namespace chip8cpp_batch
@@ -0,0 +1,28 @@
+#include <chip8cpp_batch/batch_runner.hpp>
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+try
+{
+    chip8cpp_batch::BatchRunner runner;
+
+    if (!runner.init(argc, argv))
+    {
+        return 1;
+    }
+
+    runner.run();
+
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Unknown exception occurred." << std::endl;
+    return 1;
+}
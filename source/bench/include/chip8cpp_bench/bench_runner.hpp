@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace chip8cpp_bench
+{
+    // What a run measures
+    enum class Benchmark : uint8_t
+    {
+        eAll = 0,    // Every benchmark below, one after the other
+        eFootprint,  // Memory of many instances running the same program, and their speed stepped round robin
+        eLoad,       // Loading from a file, from a copied buffer and from a view of a buffer
+        eRestart,    // Restarting after a run, compared with loading the program again
+        eCheckpoint, // Saving and restoring checkpoints, alone and around a run-ahead frame
+        eHooks,      // Interpreter speed without a debugger and with one attached
+        eDispatch,   // Opcode dispatch through the old inline switch, the index table and a table of handler pointers
+    };
+
+    // Command line options
+    struct BenchOptions
+    {
+        Benchmark                benchmark {Benchmark::eAll}; // Benchmark to run
+        std::vector<std::string> programFiles;                // Programs to measure, each one separately
+        uint32_t                 runCount {7};                // Timed runs, the fastest one is reported
+        uint32_t                 instanceCount {10000};       // Instances of the footprint benchmark
+        uint32_t                 cycleCount {200};            // Instructions run before each measured call
+    };
+
+    // Measures the core on real programs and prints one line per benchmark and program. Timings are the best of
+    // --runs runs, so they show what the code costs rather than what the machine was busy with.
+    class BenchRunner
+    {
+    public:
+        BenchRunner()  = default;
+        ~BenchRunner() = default;
+
+        bool init(int argc, char* argv[]);
+        void run();
+
+    private:
+        bool parseArguments(int argc, char* argv[]);
+        bool isSelected(Benchmark benchmark) const;
+
+        void measureFootprint(const std::string& programFile, std::shared_ptr<const chip8cpp::ProgramImage> image);
+        void measureLoad(const std::string& programFile);
+        void measureRestart(const std::string& programFile, std::shared_ptr<const chip8cpp::ProgramImage> image);
+        void measureCheckpoint(const std::string& programFile, std::shared_ptr<const chip8cpp::ProgramImage> image);
+        void measureHooks(const std::string& programFile, std::shared_ptr<const chip8cpp::ProgramImage> image);
+        void measureDispatch(const std::string& programFile, std::shared_ptr<const chip8cpp::ProgramImage> image);
+
+    private:
+        BenchOptions                                               m_Options; // Command line options
+        std::vector<std::shared_ptr<const chip8cpp::ProgramImage>> m_Images;  // Loaded programs, by program file
+        std::shared_ptr<const chip8cpp::Config>                    m_Config;  // Config shared by every instance
+    };
+} // namespace chip8cpp_bench
@@ -0,0 +1,516 @@
+#include <chip8cpp_bench/bench_runner.hpp>
+
+#include <chip8cpp/detail/dispatch.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    // Instructions run per instance before stepping the next one, like a frame of a batch of environments
+    constexpr uint32_t CyclesPerFrame = 10;
+
+    // Calls timed per run of the benchmarks of a single call, so the clock's resolution doesn't matter
+    constexpr uint32_t CallCount = 10000;
+
+    // Instructions run ahead between saving and restoring a checkpoint, 3 frames of the app at 10 per frame
+    constexpr uint32_t RunAheadCycles = 30;
+
+    // Instructions per run of the interpreter speed benchmarks, restarting the program every --cycles instructions
+    constexpr uint32_t SpeedCycles = 1000000;
+
+    constexpr std::pair<chip8cpp_bench::Benchmark, const char*> BenchmarkNames[] = {
+        {chip8cpp_bench::Benchmark::eAll, "all"},
+        {chip8cpp_bench::Benchmark::eFootprint, "footprint"},
+        {chip8cpp_bench::Benchmark::eLoad, "load"},
+        {chip8cpp_bench::Benchmark::eRestart, "restart"},
+        {chip8cpp_bench::Benchmark::eCheckpoint, "checkpoint"},
+        {chip8cpp_bench::Benchmark::eHooks, "hooks"},
+        {chip8cpp_bench::Benchmark::eDispatch, "dispatch"},
+    };
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& value)
+    {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc {} && end == text.data() + text.size();
+    }
+
+    // Seconds of the fastest of `runCount` runs of `function`, `prepare` runs untimed before each of them
+    template <typename Prepare, typename Function>
+    double measureBest(uint32_t runCount, Prepare prepare, Function function)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double best = std::numeric_limits<double>::max();
+        for (uint32_t run = 0; run < runCount; ++run)
+        {
+            prepare();
+
+            const Clock::time_point start = Clock::now();
+            function();
+            const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    // Seconds of one `call`, timed one call at a time after an untimed `prepare`, for calls that need a fresh state.
+    // Averaged over CallCount calls, best of `runCount` runs.
+    template <typename Prepare, typename Call>
+    double measureCall(uint32_t runCount, Prepare prepare, Call call)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const auto timeCalls = [&](auto function)
+        {
+            double best = std::numeric_limits<double>::max();
+            for (uint32_t run = 0; run < runCount; ++run)
+            {
+                Clock::duration total {};
+                for (uint32_t i = 0; i < CallCount; ++i)
+                {
+                    prepare();
+
+                    const Clock::time_point start = Clock::now();
+                    function();
+                    total += Clock::now() - start;
+                }
+                best = std::min(best, std::chrono::duration<double>(total).count());
+            }
+            return best / CallCount;
+        };
+
+        // Reading the clock costs about as much as the cheapest calls measured, so that is taken off
+        return std::max(0.0, timeCalls(call) - timeCalls([]() {}));
+    }
+
+    // Seconds per instruction of the interpreter running the first `cycleCount` instructions of a program over and
+    // over, programs that halt or wait for a key early would otherwise only time that loop
+    double measureSpeed(uint32_t runCount, chip8cpp::Chip8& chip8, uint32_t cycleCount)
+    {
+        const uint32_t restartCount = std::max(SpeedCycles / cycleCount, 1u);
+        return measureBest(runCount,
+                           []() {},
+                           [&]()
+                           {
+                               for (uint32_t i = 0; i < restartCount; ++i)
+                               {
+                                   chip8.restart();
+                                   chip8.emulateCycles(cycleCount);
+                               }
+                           }) /
+               (static_cast<double>(restartCount) * cycleCount);
+    }
+
+    // Like measureSpeed(), with the interpreter's cycle rebuilt around `execute`, so only the dispatch differs
+    template <typename Execute>
+    double measureDispatchSpeed(uint32_t runCount, chip8cpp::Chip8& chip8, uint32_t cycleCount, Execute execute)
+    {
+        using chip8cpp::detail::Instructions;
+
+        const uint32_t restartCount = std::max(SpeedCycles / cycleCount, 1u);
+        return measureBest(runCount,
+                           []() {},
+                           [&]()
+                           {
+                               for (uint32_t i = 0; i < restartCount; ++i)
+                               {
+                                   chip8.restart();
+                                   for (uint32_t cycle = 0; cycle < cycleCount; ++cycle)
+                                   {
+                                       const uint16_t PC     = Instructions::getPC(chip8);
+                                       const uint16_t opcode = static_cast<uint16_t>(chip8.readMemory(PC) << 8 |
+                                                                                     chip8.readMemory(PC + 1));
+                                       execute(opcode);
+                                       Instructions::endCycle(chip8);
+                                   }
+                               }
+                           }) /
+               (static_cast<double>(restartCount) * cycleCount);
+    }
+} // namespace
+
+namespace chip8cpp_bench
+{
+    bool BenchRunner::init(int argc, char* argv[])
+    {
+        if (!parseArguments(argc, argv))
+        {
+            std::string names;
+            for (const auto& [benchmark, name] : BenchmarkNames)
+            {
+                names += names.empty() ? name : std::string(" | ") + name;
+            }
+            std::cerr << "Usage: " << argv[0]
+                      << " [--runs <count>] [--instances <count>] [--cycles <count>] <" << names
+                      << "> program_file..." << std::endl;
+            return false;
+        }
+
+        for (const std::string& programFile : m_Options.programFiles)
+        {
+            m_Images.push_back(chip8cpp::ProgramImage::loadFromFile(programFile));
+            if (!m_Images.back())
+            {
+                std::cerr << "Failed to load program: " << programFile << std::endl;
+                return false;
+            }
+        }
+
+        // Traps would print on every run, and the key states on every instruction in debug builds
+        chip8cpp::Config config {};
+        config.printTraps = false;
+#ifdef DEBUG
+        config.printKeyStates = false;
+#endif
+        m_Config = std::make_shared<const chip8cpp::Config>(config);
+        return true;
+    }
+
+    void BenchRunner::run()
+    {
+        for (size_t i = 0; i < m_Options.programFiles.size(); ++i)
+        {
+            if (isSelected(Benchmark::eFootprint))
+            {
+                measureFootprint(m_Options.programFiles[i], m_Images[i]);
+            }
+            if (isSelected(Benchmark::eLoad))
+            {
+                measureLoad(m_Options.programFiles[i]);
+            }
+            if (isSelected(Benchmark::eRestart))
+            {
+                measureRestart(m_Options.programFiles[i], m_Images[i]);
+            }
+            if (isSelected(Benchmark::eCheckpoint))
+            {
+                measureCheckpoint(m_Options.programFiles[i], m_Images[i]);
+            }
+            if (isSelected(Benchmark::eHooks))
+            {
+                measureHooks(m_Options.programFiles[i], m_Images[i]);
+            }
+            if (isSelected(Benchmark::eDispatch))
+            {
+                measureDispatch(m_Options.programFiles[i], m_Images[i]);
+            }
+        }
+    }
+
+    bool BenchRunner::parseArguments(int argc, char* argv[])
+    {
+        bool hasBenchmark = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--runs" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.runCount) || m_Options.runCount == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--instances" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.instanceCount) || m_Options.instanceCount == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--cycles" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.cycleCount) || m_Options.cycleCount == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument.starts_with("--"))
+            {
+                return false; // Unknown option
+            }
+            else if (!hasBenchmark)
+            {
+                const auto* found = std::ranges::find(BenchmarkNames, argument, [](const auto& entry) {
+                    return std::string_view(entry.second);
+                });
+                if (found == std::end(BenchmarkNames))
+                {
+                    return false;
+                }
+                m_Options.benchmark = found->first;
+                hasBenchmark        = true;
+            }
+            else
+            {
+                m_Options.programFiles.push_back(argument);
+            }
+        }
+
+        return hasBenchmark && !m_Options.programFiles.empty();
+    }
+
+    bool BenchRunner::isSelected(Benchmark benchmark) const
+    {
+        return m_Options.benchmark == Benchmark::eAll || m_Options.benchmark == benchmark;
+    }
+
+    void BenchRunner::measureFootprint(const std::string&                            programFile,
+                                       std::shared_ptr<const chip8cpp::ProgramImage> image)
+    {
+        // Every instance shares the program image and the config, only the pages a program writes are its own
+        std::vector<chip8cpp::Chip8> instances;
+        instances.reserve(m_Options.instanceCount);
+        for (uint32_t i = 0; i < m_Options.instanceCount; ++i)
+        {
+            chip8cpp::Chip8& chip8 = instances.emplace_back(m_Config);
+            chip8.loadProgram(image);
+            chip8.setRandomSeed(i + 1);
+        }
+
+        // Stepped a frame at a time each, so the instances compete for the caches like a batch of environments does
+        const double seconds = measureBest(
+            m_Options.runCount,
+            [&]()
+            {
+                for (chip8cpp::Chip8& chip8 : instances)
+                {
+                    chip8.restart();
+                }
+            },
+            [&]()
+            {
+                for (uint32_t cycle = 0; cycle < m_Options.cycleCount; cycle += CyclesPerFrame)
+                {
+                    for (chip8cpp::Chip8& chip8 : instances)
+                    {
+                        chip8.emulateCycles(std::min(CyclesPerFrame, m_Options.cycleCount - cycle));
+                    }
+                }
+            });
+
+        size_t privatePageCount = 0;
+        for (const chip8cpp::Chip8& chip8 : instances)
+        {
+            privatePageCount += chip8.getPrivatePageCount();
+        }
+        const double pagesPerInstance = static_cast<double>(privatePageCount) / instances.size();
+
+        std::cout << std::format("{}: footprint: {} B instance + {:.2f} private pages of {} B = {:.0f} B per instance, "
+                                 "{:.2f} ns per instruction over {} instances\n",
+                                 programFile,
+                                 sizeof(chip8cpp::Chip8),
+                                 pagesPerInstance,
+                                 chip8cpp::constants::PageSize,
+                                 sizeof(chip8cpp::Chip8) + pagesPerInstance * chip8cpp::constants::PageSize,
+                                 seconds * 1e9 / (static_cast<double>(m_Options.cycleCount) * instances.size()),
+                                 instances.size());
+    }
+
+    void BenchRunner::measureLoad(const std::string& programFile)
+    {
+        std::ifstream              file(programFile, std::ios::binary);
+        const std::vector<uint8_t> program {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+        // Every load resets the instance as well, that is part of what a host waits for
+        chip8cpp::Chip8 chip8(m_Config);
+        const auto      measureLoads = [&](auto load)
+        {
+            return measureBest(
+                       m_Options.runCount,
+                       []() {},
+                       [&]()
+                       {
+                           for (uint32_t i = 0; i < CallCount; ++i)
+                           {
+                               load();
+                           }
+                       }) *
+                   1e6 / CallCount;
+        };
+
+        const double fileMicroseconds = measureLoads([&]() { chip8.loadProgram(programFile); });
+        const double copyMicroseconds = measureLoads([&]() { chip8.loadProgram(std::span(program)); });
+        const double viewMicroseconds = measureLoads([&]() { chip8.loadProgramView(program); });
+
+        std::cout << std::format("{}: load: {:.3f} us from the file, {:.3f} us copied, {:.3f} us as a view\n",
+                                 programFile,
+                                 fileMicroseconds,
+                                 copyMicroseconds,
+                                 viewMicroseconds);
+    }
+
+    void BenchRunner::measureRestart(const std::string&                            programFile,
+                                     std::shared_ptr<const chip8cpp::ProgramImage> image)
+    {
+        // Both return to the state right after loading, restart() only undoes what the run changed
+        chip8cpp::Chip8 chip8(m_Config);
+        chip8.loadProgram(image);
+
+        const auto runProgram = [&]() { chip8.emulateCycles(m_Options.cycleCount); };
+
+        const double restartSeconds = measureCall(m_Options.runCount, runProgram, [&]() { chip8.restart(); });
+        const double reloadSeconds  = measureCall(m_Options.runCount, runProgram, [&]() { chip8.loadProgram(image); });
+
+        std::cout << std::format("{}: restart: {:.0f} ns, {:.0f} ns to load the program again, after {} instructions\n",
+                                 programFile,
+                                 restartSeconds * 1e9,
+                                 reloadSeconds * 1e9,
+                                 m_Options.cycleCount);
+    }
+
+    void BenchRunner::measureCheckpoint(const std::string&                            programFile,
+                                        std::shared_ptr<const chip8cpp::ProgramImage> image)
+    {
+        // Both calls copy the lines the program wrote since loading, so the program runs first.
+        // Restores alternate between two states a frame apart, so each one has something to undo.
+        chip8cpp::Chip8 chip8(m_Config);
+        chip8.loadProgram(image);
+        chip8.emulateCycles(m_Options.cycleCount);
+
+        chip8cpp::Checkpoint checkpoint;
+        chip8cpp::Checkpoint nextFrame;
+        chip8cpp::Checkpoint saved;
+        chip8.saveCheckpoint(checkpoint);
+        chip8.emulateCycles(CyclesPerFrame);
+        chip8.saveCheckpoint(nextFrame);
+
+        const auto measureLoop = [&](auto body)
+        {
+            return measureBest(m_Options.runCount,
+                               []() {},
+                               [&]()
+                               {
+                                   for (uint32_t i = 0; i < CallCount; ++i)
+                                   {
+                                       body();
+                                   }
+                               }) /
+                   CallCount;
+        };
+
+        const auto restoreBoth = [&]()
+        {
+            chip8.restoreCheckpoint(checkpoint);
+            chip8.restoreCheckpoint(nextFrame);
+        };
+
+        const double saveSeconds    = measureLoop([&]() { chip8.saveCheckpoint(saved); });
+        const double restoreSeconds = measureLoop(restoreBoth) / 2;
+
+        // What the app adds to every frame with --run-ahead
+        const double runAheadSeconds = measureLoop(
+            [&]()
+            {
+                chip8.saveCheckpoint(saved);
+                chip8.emulateCycles(RunAheadCycles);
+                chip8.restoreCheckpoint(saved);
+            });
+
+        std::cout << std::format("{}: checkpoint: save {:.0f} ns, restore {:.0f} ns, save + {} instructions + restore "
+                                 "{:.0f} ns, after {} instructions\n",
+                                 programFile,
+                                 saveSeconds * 1e9,
+                                 restoreSeconds * 1e9,
+                                 RunAheadCycles,
+                                 runAheadSeconds * 1e9,
+                                 m_Options.cycleCount);
+    }
+
+    void BenchRunner::measureHooks(const std::string&                            programFile,
+                                   std::shared_ptr<const chip8cpp::ProgramImage> image)
+    {
+        using chip8cpp::detail::Instructions;
+
+        chip8cpp::Chip8 chip8(m_Config);
+        chip8.loadProgram(image);
+        const double noHooksSeconds = measureSpeed(m_Options.runCount, chip8, m_Options.cycleCount);
+
+        // Nothing to hit, so this is what every instruction pays for the checks
+        chip8cpp::Debugger debugger;
+        chip8.attachDebugger(&debugger);
+        const double debuggerSeconds = measureSpeed(m_Options.runCount, chip8, m_Options.cycleCount);
+        chip8.attachDebugger(nullptr);
+
+        // The interpreter before the hook policies, which had no debugger to check for
+        const double baselineSeconds = measureDispatchSpeed(m_Options.runCount,
+                                                            chip8,
+                                                            m_Options.cycleCount,
+                                                            [&chip8](uint16_t opcode)
+                                                            { Instructions::executeBySwitch(chip8, opcode); });
+
+        std::cout << std::format("{}: hooks: {:.2f} ns per instruction without a debugger, {:.2f} ns with one "
+                                 "attached, {:.2f} ns before the hooks\n",
+                                 programFile,
+                                 noHooksSeconds * 1e9,
+                                 debuggerSeconds * 1e9,
+                                 baselineSeconds * 1e9);
+    }
+
+    void BenchRunner::measureDispatch(const std::string&                            programFile,
+                                      std::shared_ptr<const chip8cpp::ProgramImage> image)
+    {
+        using chip8cpp::detail::Handler;
+        using chip8cpp::detail::HandlerTable;
+        using chip8cpp::detail::Instructions;
+        using chip8cpp::detail::NoHooks;
+
+        chip8cpp::Chip8 chip8(m_Config);
+        chip8.loadProgram(image);
+
+        // The same handlers behind both tables, the interpreter uses the index table
+        const chip8cpp::detail::DispatchIndex dispatchIndex = chip8cpp::detail::makeDispatchIndex();
+        std::vector<Handler>                  handlerPointers(dispatchIndex.size());
+        for (size_t opcode = 0; opcode < dispatchIndex.size(); ++opcode)
+        {
+            handlerPointers[opcode] = HandlerTable<NoHooks>[dispatchIndex[opcode]];
+        }
+
+        const auto switchDispatch  = [&chip8](uint16_t opcode) { Instructions::executeBySwitch(chip8, opcode); };
+        const auto indexDispatch   = [&chip8, &dispatchIndex](uint16_t opcode)
+        { HandlerTable<NoHooks>[dispatchIndex[opcode]](chip8, opcode); };
+        const auto pointerDispatch = [&chip8, &handlerPointers](uint16_t opcode)
+        { handlerPointers[opcode](chip8, opcode); };
+
+        const double switchSeconds =
+            measureDispatchSpeed(m_Options.runCount, chip8, m_Options.cycleCount, switchDispatch);
+        const double indexSeconds =
+            measureDispatchSpeed(m_Options.runCount, chip8, m_Options.cycleCount, indexDispatch);
+        const double pointerSeconds =
+            measureDispatchSpeed(m_Options.runCount, chip8, m_Options.cycleCount, pointerDispatch);
+        const double interpreterSeconds = measureSpeed(m_Options.runCount, chip8, m_Options.cycleCount);
+
+        // The distinct handlers a program runs are the code the tables keep hot, the switch is one function
+        std::vector<bool> isHandlerUsed(chip8cpp::detail::HandlerCount);
+        size_t            handlerCount = 0;
+        measureDispatchSpeed(1,
+                             chip8,
+                             m_Options.cycleCount,
+                             [&](uint16_t opcode)
+                             {
+                                 const uint16_t index = dispatchIndex[opcode];
+                                 handlerCount += isHandlerUsed[index] ? 0 : 1;
+                                 isHandlerUsed[index] = true;
+                                 HandlerTable<NoHooks>[index](chip8, opcode);
+                             });
+
+        std::cout << std::format("{}: dispatch: {:.2f} ns per instruction through the inline switch, {:.2f} ns "
+                                 "through the index table, {:.2f} ns through a pointer table, {:.2f} ns in the "
+                                 "interpreter, {} distinct handlers run\n",
+                                 programFile,
+                                 switchSeconds * 1e9,
+                                 indexSeconds * 1e9,
+                                 pointerSeconds * 1e9,
+                                 interpreterSeconds * 1e9,
+                                 handlerCount);
+    }
+} // namespace chip8cpp_bench
@@ -0,0 +1,96 @@
+#ifndef CHIP8CPP_C_H
+#define CHIP8CPP_C_H
+
+/*
+ * Stable C API over a batch of Chip8 environments, meant for reinforcement learning hosts that drive the interpreter
+ * through an FFI such as Python's ctypes. One call steps every environment by a frame, and the observations of all
+ * environments live in one contiguous buffer that can be wrapped without copying, e.g. with numpy:
+ *
+ *   obs = np.ctypeslib.as_array(lib.chip8cpp_batch_observations(batch), shape=(count, 32, 64))
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(CHIP8CPP_CAPI_EXPORTS)
+#define CHIP8CPP_API __declspec(dllexport)
+#else
+#define CHIP8CPP_API __declspec(dllimport)
+#endif
+#else
+#define CHIP8CPP_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CHIP8CPP_API_VERSION 2
+
+    typedef struct chip8cpp_batch chip8cpp_batch;
+
+    /* Layout of the observation buffer */
+    typedef enum chip8cpp_observation_format
+    {
+        CHIP8CPP_OBSERVATION_BYTES  = 0, /* count x 32 x 64 bytes, 0 or 1 per pixel */
+        CHIP8CPP_OBSERVATION_PACKED = 1  /* count x 32 x 8 bytes, one bit per pixel, most significant bit leftmost */
+    } chip8cpp_observation_format;
+
+    /* Returns CHIP8CPP_API_VERSION of the loaded library */
+    CHIP8CPP_API int chip8cpp_api_version(void);
+
+    /*
+     * Creates `count` environments running a copy of `program`, all sharing one memory image.
+     * Frames run `cycles_per_frame` instructions, spread over `thread_count` threads (0 picks the core count).
+     * Episode k of environment i (k counts the resets of the environment) seeds its random number generator with
+     * `seed + i + k * count`. Returns NULL on invalid arguments or when the environments or threads can't be created.
+     */
+    CHIP8CPP_API chip8cpp_batch* chip8cpp_batch_create(const uint8_t*              program,
+                                                       size_t                      program_size,
+                                                       size_t                      count,
+                                                       uint32_t                    cycles_per_frame,
+                                                       chip8cpp_observation_format observation_format,
+                                                       uint32_t                    thread_count,
+                                                       uint32_t                    seed);
+
+    CHIP8CPP_API void chip8cpp_batch_destroy(chip8cpp_batch* batch);
+
+    /* Number of environments in the batch */
+    CHIP8CPP_API size_t chip8cpp_batch_count(const chip8cpp_batch* batch);
+
+    /*
+     * Adds `scale` times the change of the byte at `address` to every step's reward, e.g. a score kept in memory.
+     * At most 64 addresses can be added per batch. Returns 0 on success, -1 when the address is out of range or
+     * 64 addresses were already added.
+     */
+    CHIP8CPP_API int chip8cpp_batch_add_reward_address(chip8cpp_batch* batch, uint16_t address, float scale);
+
+    /*
+     * Restarts the environments whose entry in `mask` is non-zero, or all of them when `mask` is NULL.
+     * Restarting only undoes the memory and display the episode touched, so it is cheap to do every episode.
+     * Each restart begins a new episode with the environment's next random seed, see chip8cpp_batch_create().
+     */
+    CHIP8CPP_API void chip8cpp_batch_reset(chip8cpp_batch* batch, const uint8_t* mask);
+
+    /*
+     * Steps every environment by one frame. `actions` holds one key bitmask per environment, bit i set when Chip8
+     * key i (0x0-0xF) is held during the frame. Observations and rewards are updated before it returns.
+     */
+    CHIP8CPP_API void chip8cpp_batch_step(chip8cpp_batch* batch, const uint16_t* actions);
+
+    /* Observations of all environments, valid until the batch is destroyed, see chip8cpp_observation_format */
+    CHIP8CPP_API const uint8_t* chip8cpp_batch_observations(const chip8cpp_batch* batch);
+
+    /* Size in bytes of one environment's observation */
+    CHIP8CPP_API size_t chip8cpp_batch_observation_size(const chip8cpp_batch* batch);
+
+    /* Rewards of the last step, one per environment, valid until the batch is destroyed */
+    CHIP8CPP_API const float* chip8cpp_batch_rewards(const chip8cpp_batch* batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHIP8CPP_C_H */
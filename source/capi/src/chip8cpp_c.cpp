@@ -0,0 +1,296 @@
+#include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp/chip8cpp_c.h>
+
+#include <algorithm>
+#include <barrier>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Reward term, scale times the change of one memory byte
+    struct RewardAddress
+    {
+        uint16_t address {0};
+        float    scale {0.0f};
+    };
+
+    void unpackObservation(const uint64_t* gfx, uint8_t* observation)
+    {
+        for (size_t y = 0; y < chip8cpp::constants::Height; ++y)
+        {
+            for (size_t x = 0; x < chip8cpp::constants::Width; ++x)
+            {
+                *observation++ = static_cast<uint8_t>((gfx[y] >> (chip8cpp::constants::Width - 1 - x)) & 1);
+            }
+        }
+    }
+} // namespace
+
+// Environments are split into one contiguous range per thread. Workers stay parked on a barrier between steps,
+// so a step costs two barrier phases instead of starting threads.
+struct chip8cpp_batch
+{
+    chip8cpp_batch(std::shared_ptr<const chip8cpp::ProgramImage> image,
+                   size_t                                        count,
+                   uint32_t                                      cyclesPerFrame,
+                   chip8cpp_observation_format                   observationFormat,
+                   uint32_t                                      threadCount,
+                   uint32_t                                      seed) :
+        environments(count),
+        cyclesPerFrame(cyclesPerFrame), observationFormat(observationFormat),
+        observationSize(observationFormat == CHIP8CPP_OBSERVATION_PACKED ?
+                            chip8cpp::constants::Height * sizeof(uint64_t) :
+                            chip8cpp::constants::GfxSize),
+        observations(count * observationSize), rewards(count), threadCount(threadCount),
+        startBarrier(threadCount), doneBarrier(threadCount), seed(seed), episodes(count)
+    {
+        // Trapped environments would print every episode, hosts see the trap in the observations instead.
+        // One config for every environment, the instances only keep a pointer to it.
+        chip8cpp::Config config {};
+        config.printTraps = false;
+        const auto sharedConfig = std::make_shared<const chip8cpp::Config>(config);
+        for (size_t i = 0; i < count; ++i)
+        {
+            environments[i].setConfig(sharedConfig);
+            environments[i].loadProgram(image);
+            environments[i].setRandomSeed(getEpisodeSeed(i));
+            writeObservation(i);
+        }
+
+        // The calling thread steps the first range itself
+        try
+        {
+            for (uint32_t i = 1; i < threadCount; ++i)
+            {
+                workers.emplace_back([this, i]() { workerLoop(i); });
+            }
+        }
+        catch (...)
+        {
+            // Release the started workers, arriving once for each one that failed to start, then let the caller
+            // see the error
+            stopping = true;
+            for (size_t i = workers.size() + 1; i < threadCount; ++i)
+            {
+                startBarrier.arrive_and_drop();
+            }
+            startBarrier.arrive_and_wait();
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+            throw;
+        }
+    }
+
+    ~chip8cpp_batch()
+    {
+        stopping = true;
+        startBarrier.arrive_and_wait();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void step(const uint16_t* stepActions)
+    {
+        actions = stepActions;
+        if (threadCount > 1)
+        {
+            startBarrier.arrive_and_wait();
+        }
+        stepRange(0);
+        if (threadCount > 1)
+        {
+            doneBarrier.arrive_and_wait();
+        }
+    }
+
+    void workerLoop(uint32_t threadIndex)
+    {
+        while (true)
+        {
+            startBarrier.arrive_and_wait();
+            if (stopping)
+            {
+                return;
+            }
+            stepRange(threadIndex);
+            doneBarrier.arrive_and_wait();
+        }
+    }
+
+    void stepRange(uint32_t threadIndex)
+    {
+        const size_t begin = environments.size() * threadIndex / threadCount;
+        const size_t end   = environments.size() * (threadIndex + 1) / threadCount;
+        for (size_t i = begin; i < end; ++i)
+        {
+            chip8cpp::Chip8& chip8 = environments[i];
+
+            for (size_t key = 0; key < chip8cpp::constants::KeyCount; ++key)
+            {
+                chip8.setKeyState(static_cast<chip8cpp::KeyCode>(key), (actions[i] >> key) & 1);
+            }
+
+            uint8_t before[MaxRewardAddresses];
+            for (size_t r = 0; r < rewardAddresses.size(); ++r)
+            {
+                before[r] = chip8.readMemory(rewardAddresses[r].address);
+            }
+
+            chip8.emulateCycles(cyclesPerFrame);
+
+            float reward = 0.0f;
+            for (size_t r = 0; r < rewardAddresses.size(); ++r)
+            {
+                const int delta = chip8.readMemory(rewardAddresses[r].address) - before[r];
+                reward += rewardAddresses[r].scale * static_cast<float>(delta);
+            }
+            rewards[i] = reward;
+
+            writeObservation(i);
+        }
+    }
+
+    // Episode k of environment i seeds with seed + i + k * count, so no two episodes of a batch share one
+    uint32_t getEpisodeSeed(size_t index) const
+    {
+        return seed + static_cast<uint32_t>(index + episodes[index] * environments.size());
+    }
+
+    void restart(size_t index)
+    {
+        ++episodes[index];
+        environments[index].restart();
+        environments[index].setRandomSeed(getEpisodeSeed(index));
+        rewards[index] = 0.0f;
+        writeObservation(index);
+    }
+
+    void writeObservation(size_t index)
+    {
+        uint8_t*        observation = &observations[index * observationSize];
+        const uint64_t* gfx         = environments[index].getGFX();
+        if (observationFormat == CHIP8CPP_OBSERVATION_PACKED)
+        {
+            // Rows are written big-endian, so the bytes read left to right on every host, e.g. for np.unpackbits
+            for (size_t y = 0; y < chip8cpp::constants::Height; ++y)
+            {
+                uint64_t row = gfx[y];
+                if constexpr (std::endian::native == std::endian::little)
+                {
+                    row = std::byteswap(row);
+                }
+                std::memcpy(observation + y * sizeof(row), &row, sizeof(row));
+            }
+        }
+        else
+        {
+            unpackObservation(gfx, observation);
+        }
+    }
+
+    static constexpr size_t MaxRewardAddresses = 64; // Reward terms per batch
+
+    std::vector<chip8cpp::Chip8> environments;      // Environments, all sharing one program image
+    uint32_t                     cyclesPerFrame;    // Instructions per step
+    chip8cpp_observation_format  observationFormat; // Layout of the observation buffer
+    size_t                       observationSize;   // Bytes per environment in the observation buffer
+    std::vector<uint8_t>         observations;      // Observations of all environments, back to back
+    std::vector<float>           rewards;           // Rewards of the last step
+    std::vector<RewardAddress>   rewardAddresses;   // Memory bytes that make up the reward
+    const uint16_t*              actions {nullptr}; // Key bitmasks of the current step
+    uint32_t                     threadCount;       // Threads stepping environments, the caller's included
+    bool                         stopping {false};  // Tells the workers to exit
+    std::barrier<>               startBarrier;      // Releases the workers into a step
+    std::barrier<>               doneBarrier;       // Waits for every worker to finish a step
+    std::vector<std::thread>     workers;           // Worker threads, one per range but the first
+    uint32_t                     seed;              // Seed of the first episode of the first environment
+    std::vector<size_t>          episodes;          // Restarts of every environment
+};
+
+extern "C"
+{
+    int chip8cpp_api_version(void) { return CHIP8CPP_API_VERSION; }
+
+    chip8cpp_batch* chip8cpp_batch_create(const uint8_t*              program,
+                                          size_t                      program_size,
+                                          size_t                      count,
+                                          uint32_t                    cycles_per_frame,
+                                          chip8cpp_observation_format observation_format,
+                                          uint32_t                    thread_count,
+                                          uint32_t                    seed)
+    {
+        if (!program || count == 0 || cycles_per_frame == 0 ||
+            (observation_format != CHIP8CPP_OBSERVATION_BYTES && observation_format != CHIP8CPP_OBSERVATION_PACKED))
+        {
+            return nullptr;
+        }
+
+        // The caller's buffer may go away after this call, so the image keeps its own copy
+        std::shared_ptr<const chip8cpp::ProgramImage> image =
+            chip8cpp::ProgramImage::create(std::span<const uint8_t>(program, program_size));
+        if (!image)
+        {
+            return nullptr;
+        }
+
+        if (thread_count == 0)
+        {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        thread_count = static_cast<uint32_t>(std::min<size_t>(thread_count, count));
+
+        // No exception may cross the C boundary, e.g. failing to allocate the environments or to start a thread
+        try
+        {
+            return new chip8cpp_batch(
+                std::move(image), count, cycles_per_frame, observation_format, thread_count, seed);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    void chip8cpp_batch_destroy(chip8cpp_batch* batch) { delete batch; }
+
+    size_t chip8cpp_batch_count(const chip8cpp_batch* batch) { return batch->environments.size(); }
+
+    int chip8cpp_batch_add_reward_address(chip8cpp_batch* batch, uint16_t address, float scale)
+    {
+        if (address >= chip8cpp::constants::MemorySize ||
+            batch->rewardAddresses.size() >= chip8cpp_batch::MaxRewardAddresses)
+        {
+            return -1;
+        }
+
+        batch->rewardAddresses.push_back({address, scale});
+        return 0;
+    }
+
+    void chip8cpp_batch_reset(chip8cpp_batch* batch, const uint8_t* mask)
+    {
+        for (size_t i = 0; i < batch->environments.size(); ++i)
+        {
+            if (!mask || mask[i] != 0)
+            {
+                batch->restart(i);
+            }
+        }
+    }
+
+    void chip8cpp_batch_step(chip8cpp_batch* batch, const uint16_t* actions) { batch->step(actions); }
+
+    const uint8_t* chip8cpp_batch_observations(const chip8cpp_batch* batch) { return batch->observations.data(); }
+
+    size_t chip8cpp_batch_observation_size(const chip8cpp_batch* batch) { return batch->observationSize; }
+
+    const float* chip8cpp_batch_rewards(const chip8cpp_batch* batch) { return batch->rewards.data(); }
+}
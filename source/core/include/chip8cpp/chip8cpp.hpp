@@ -1,7 +1,10 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 namespace chip8cpp
@@ -12,6 +15,10 @@ namespace chip8cpp
         constexpr uint8_t  Height              = 32;             // Height of the Chip-8 screen in pixels
         constexpr uint16_t ProgramStartAddress = 0x200;          // Starting address for programs in Chip-8 memory
         constexpr size_t   MemorySize          = 4096;           // Total memory size for Chip-8
+        constexpr size_t   PageSize            = 256;            // Size of a copy-on-write memory page
+        constexpr size_t   PageCount           = 16;             // Number of memory pages (MemorySize / PageSize)
+        constexpr size_t   LineSize            = 64;             // Size of a dirty-tracked memory line
+        constexpr size_t   LineCount           = 64;             // Number of memory lines (MemorySize / LineSize)
         constexpr size_t   StackSize           = 16;             // Size of the stack for Chip-8
         constexpr size_t   GfxSize             = Width * Height; // Size of the graphics buffer (64x32 pixels)
         constexpr size_t   FontSetSize         = 80;             // Size of the font set (5x16 pixels for 16 characters)
@@ -20,16 +27,18 @@ namespace chip8cpp
         constexpr size_t   KeyCount            = 16;             // Number of keys in Chip-8 (0-F)
     } // namespace constants
 
+    // Settings read outside the instruction loop, so instances keep a pointer to them instead of a copy.
+    // One Config can be shared by every instance of a batch, its callback may then be called from several threads.
     struct Config
     {
         int                   pixelScale {10};       // Scale factor for each pixel in the graphics buffer
         int                   pixelOutlineWidth {1}; // Width of pixel outlines in the graphics buffer
         bool                  pixelOutline {false};  // Whether to draw pixel outlines in the graphics buffer
         std::function<void()> soundCallback;         // Callback function for sound events
+        bool                  printTraps {true};     // Whether to print traps in the console
 
 #ifdef DEBUG
-        bool printAsciiGraphics {false}; // Whether to print graphics buffer as ASCII art in the console
-        bool printKeyStates {true};      // Whether to print key states in the console
+        bool printKeyStates {true}; // Whether to print key states in the console
 #endif
     };
 
@@ -60,49 +69,277 @@ namespace chip8cpp
         eF,
     };
 
+    // Reason the interpreter stopped making progress, it stays on the faulting instruction until restarted
+    enum class Trap
+    {
+        eNone = 0,
+        eUnknownOpcode,     // The opcode is not a Chip-8 instruction, e.g. a Super-CHIP one
+        eStackOverflow,     // 2NNN with all stack entries in use
+        eStackUnderflow,    // 00EE with an empty stack
+        eMemoryOutOfBounds, // DXYN, FX33, FX55 or FX65 would access memory past the end from I
+    };
+
+    const char* getKeyCodeName(KeyCode keyCode);
+    const char* getTrapName(Trap trap);
+
+    class Chip8;
+
+    namespace detail
+    {
+        struct Instructions;
+    } // namespace detail
+
+    // Copy of the machine state, for tools that inspect it while the interpreter keeps running
+    struct Snapshot
+    {
+        uint8_t  V[constants::RegisterCount] {};   // Registers
+        uint16_t I {0};                            // Index register
+        uint16_t PC {0};                           // Program counter
+        uint8_t  SP {0};                           // Stack pointer
+        uint8_t  delayTimer {0};                   // Delay timer
+        uint8_t  soundTimer {0};                   // Sound timer
+        uint16_t stack[constants::StackSize] {};   // Stack
+        uint8_t  keys[constants::KeyCount] {};     // Key states
+        uint64_t gfx[constants::Height] {};        // Graphics buffer, one bit per pixel
+        uint8_t  memory[constants::MemorySize] {}; // Memory
+    };
+
+    // Saved interpreter state to roll back to, see Chip8::saveCheckpoint().
+    // It has a fixed size, so saving and restoring never allocate. Packed, it only keeps the memory lines and graphics
+    // rows that were changed, for tools that store many states.
+    class Checkpoint
+    {
+    public:
+        void pack(std::vector<uint8_t>& bytes) const;
+        bool unpack(std::span<const uint8_t> bytes);
+
+    private:
+        friend class Chip8;
+
+        Snapshot m_State {};         // Registers, timers, keys, graphics buffer and the saved memory lines
+        bool     m_DrawFlag {false}; // Draw flag
+        bool     m_IsValid {false};  // Validity
+        Trap     m_Trap {};          // Trap the interpreter was stopped by
+        uint32_t m_RandomState {0};  // Random number generator state
+        uint64_t m_DirtyLines {0};   // Memory lines that differed from the program image, the only ones saved
+        uint32_t m_DirtyRows {0};    // Changed graphics buffer rows
+        uint64_t m_MemoryHash {0};   // Hash of the memory differences from the program image
+    };
+
+    // Immutable memory image (font set + program) shared by every Chip8 instance running the same ROM.
+    // Instances read straight from these pages and only copy a page when they first write to it.
+    // The font set and empty pages are shared by all images, a view maps whole program pages onto the caller's bytes.
+    class ProgramImage
+    {
+    public:
+        static std::shared_ptr<const ProgramImage> loadFromFile(const std::string& fileName);
+        static std::shared_ptr<const ProgramImage> create(std::span<const uint8_t> program);
+        static std::shared_ptr<const ProgramImage> createView(std::span<const uint8_t> program);
+
+        const uint8_t* getPage(size_t pageIndex) const;
+        size_t         getProgramSize() const;
+
+    private:
+        ProgramImage();
+
+        void mapProgram(const uint8_t* program, size_t programSize);
+
+    private:
+        const uint8_t*             m_Pages[constants::PageCount] {}; // Every page of the memory image
+        std::unique_ptr<uint8_t[]> m_OwnedBytes;                     // Program bytes owned by the image, if any
+        size_t                     m_ProgramSize {0};                // Size of the program in bytes
+    };
+
+    enum class DebugEventType
+    {
+        eBreakpoint = 0, // The PC reached a breakpoint, the instruction there has not run yet
+        eReadWatch,      // An instruction read a watched address
+        eWriteWatch,     // An instruction wrote a watched address
+    };
+
+    struct DebugEvent
+    {
+        DebugEventType type {DebugEventType::eBreakpoint}; // What halted the interpreter
+        uint16_t       PC {0};                             // Address of the instruction that hit the event
+        uint16_t       address {0};                        // Breakpoint or accessed address
+    };
+
+    // PC breakpoints and memory watchpoints, checked only while attached to a Chip8 with Chip8::attachDebugger().
+    // Each kind is one bit per address, so a check is a single load whatever the number of breakpoints.
+    // A hit halts the interpreter until resume(), watchpoints halt after the accessing instruction completes.
+    // Watch ranges are [begin, end), the part past the end of memory is ignored.
+    class Debugger
+    {
+    public:
+        void setBreakpoint(uint16_t address, bool isEnabled = true);
+        void setReadWatch(uint16_t begin, uint16_t end, bool isEnabled = true);
+        void setWriteWatch(uint16_t begin, uint16_t end, bool isEnabled = true);
+        void clear();
+
+        bool hasBreakpoint(uint16_t address) const;
+        bool isReadWatched(uint16_t address) const;
+        bool isWriteWatched(uint16_t address) const;
+
+        void setEventCallback(std::function<void(const DebugEvent&)> eventCallback);
+
+        bool              isHalted() const;
+        const DebugEvent& getLastEvent() const;
+        void              resume();
+
+    private:
+        friend class Chip8;
+        friend struct detail::Instructions;
+
+        using AddressBitmap = uint64_t[constants::MemorySize / 64];
+
+        bool checkBreakpoint(uint16_t pc);
+        void checkRead(uint16_t address, uint16_t pc);
+        void checkWrite(uint16_t address, uint16_t pc);
+        void halt(const DebugEvent& event);
+
+        static bool testBit(const AddressBitmap& bitmap, uint16_t address);
+        static void setBits(AddressBitmap& bitmap, uint16_t begin, uint16_t end, bool isEnabled);
+
+    private:
+        AddressBitmap m_Breakpoints {};         // One bit per address with a breakpoint
+        AddressBitmap m_ReadWatches {};         // One bit per address watched for reads
+        AddressBitmap m_WriteWatches {};        // One bit per address watched for writes
+        bool          m_IsHalted {false};       // Whether an event halted the interpreter
+        bool          m_SkipBreakpoint {false}; // Run the instruction at the breakpoint that was resumed from
+        DebugEvent    m_LastEvent {};           // Event that halted the interpreter last
+
+        std::function<void(const DebugEvent&)> m_EventCallback; // Called on every event, before halting
+    };
+
+    // Straight-line run of a program compiled to native code, runs up to `cycleBudget` instructions starting with the
+    // instruction at index `entry` and returns how many it ran
+    struct CompiledBlock
+    {
+        uint16_t startAddress {0};     // Address of the first instruction
+        uint16_t instructionCount {0}; // Number of instructions
+        uint64_t lineMask {0};         // Memory lines the instructions were compiled from, one bit per line
+        uint32_t (*run)(Chip8& chip8, uint32_t entry, uint32_t cycleBudget) {nullptr}; // Native code
+    };
+
+    // Program compiled ahead of time by chip8cpp-aot, see add_compiled_program() in cmake/common.cmake.
+    // Blocks only run while their memory lines are unmodified, anything else falls back to the interpreter.
+    struct CompiledProgram
+    {
+        std::span<const uint8_t>       program;    // Program the blocks were compiled from
+        std::span<const CompiledBlock> blocks;     // Compiled blocks
+        std::span<const uint16_t>      blockIndex; // Block index + 1 for every address inside a block, 0 elsewhere
+    };
+
     class Chip8
     {
     public:
         explicit Chip8(const Config& config = {});
+        explicit Chip8(std::shared_ptr<const Config> config);
 
         void          setConfig(const Config& config);
+        void          setConfig(std::shared_ptr<const Config> config);
         const Config& getConfig() const;
 
         bool loadProgram(const std::string& fileName);
+        bool loadProgram(std::shared_ptr<const ProgramImage> image);
+        bool loadProgram(std::span<const uint8_t> program);
+        bool loadProgram(const CompiledProgram& program);
+
+        // Maps the program without copying, so it has to outlive this instance, e.g. an embedded or compiled program.
+        // loadProgram() copies it instead, the caller's buffer can go away after the call.
+        bool loadProgramView(std::span<const uint8_t> program);
 
         void emulateOneCycle();
 
+        // Returns the instructions that ran, cycles retrying a trapped instruction or halted by the debugger don't
+        // count
+        uint32_t emulateCycles(uint32_t cycleCount);
+        void restart();
+
+        void saveCheckpoint(Checkpoint& checkpoint) const;
+        void restoreCheckpoint(const Checkpoint& checkpoint);
+
+        void setRandomSeed(uint32_t seed);
+
+        void attachDebugger(Debugger* debugger);
+
+        uint8_t  readMemory(uint16_t address) const;
+        size_t   getPrivatePageCount() const;
+        uint16_t getPC() const;
+        void     captureSnapshot(Snapshot& snapshot) const;
+
         bool isKeyPressed(KeyCode keyCode) const;
         void setKeyState(KeyCode keyCode, bool isPressed);
 
-        bool getDrawFlag() const;
+        bool     getDrawFlag() const;
+        Trap     getTrap() const;
+        uint64_t getStateHash() const;
 
-        const uint8_t* getGFX() const;
+        const uint64_t* getGFX() const;
+        bool            getPixel(size_t x, size_t y) const;
 
     private:
+        friend struct detail::Instructions;
+
         void reset();
 
+        template <typename Hooks>
+        void executeCycle();
+        template <typename Hooks>
+        void decodeAndExecuteOpcode(uint16_t opcode);
+
         uint16_t fetchOpcode();
-        void     decodeAndExecuteOpcode(uint16_t opcode);
         void     updateTimers();
+        void     raiseTrap(Trap trap, uint16_t opcode);
 
-        void loadFontSet();
+        void checkCompiledLines(uint64_t lines);
+
+#ifdef DEBUG
+        void printKeyStates() const;
+#endif
+
+        void writeMemory(uint16_t address, uint8_t value);
+        void restoreLine(size_t line, const uint8_t* source);
+        void makePagePrivate(size_t pageIndex);
+
+        uint8_t nextRandomByte();
 
     private:
-        Config m_Config {}; // Configuration settings
+        struct MemoryPage
+        {
+            alignas(64) uint8_t bytes[constants::PageSize];
+        };
 
+    private:
         uint8_t  m_V[constants::RegisterCount] {};      // Registers
         uint8_t  m_DelayTimer {0};                      // Delay timer
         uint8_t  m_SoundTimer {0};                      // Sound timer
         uint8_t  m_SP {0};                              // Stack pointer
         uint8_t  m_Keys[constants::KeyCount] {};        // Key states, 0 for up, 1 for down, KeyCode is the index
-        uint8_t  m_GFX[constants::GfxSize] {};          // Graphics buffer (64x32 pixels)
+        uint64_t m_GFX[constants::Height] {};           // Graphics buffer (64x32 pixels), one bit per pixel
         bool     m_DrawFlag {false};                    // Flag to indicate if a redraw is needed
         uint16_t m_I {0};                               // Index register
         uint16_t m_PC {constants::ProgramStartAddress}; // Program counter, starts at 0x200
         uint16_t m_Stack[constants::StackSize] {};      // Stack
-        uint8_t  m_Memory[constants::MemorySize] {};    // Memory
+        uint64_t m_DirtyLines {0};                      // Memory lines written since loading, one bit per line
+        uint32_t m_DirtyRows {0};                       // Graphics buffer rows changed since loading, one bit per row
+        uint32_t m_RandomSeed {1};                      // Seed of the random number generator, restored on restart
+        uint32_t m_RandomState {1};                     // Xorshift random number generator state, never 0
+        Trap     m_Trap {Trap::eNone};                  // Trap the interpreter is stopped by, if any
+        uint64_t m_MemoryHash {0};                      // Hash of the memory differences, updated on every write
+
+        std::shared_ptr<const ProgramImage> m_Image;                             // Shared font set + program image
+        const uint8_t*                      m_PageTable[constants::PageCount] {};    // Readable view of every page
+        std::shared_ptr<MemoryPage>         m_PrivatePages[constants::PageCount] {}; // Pages copied on first write
+
+        std::shared_ptr<const Config> m_Config; // Configuration settings, only read on sounds, traps and in debug builds
+
+        Debugger*              m_Debugger {nullptr};        // Attached debugger, not owned
+        const CompiledProgram* m_CompiledProgram {nullptr}; // Native code of the loaded program, if any
+        uint64_t               m_CheckedLines {0};          // Dirty lines compared with the compiled code since written
+        uint64_t               m_ModifiedCodeLines {0};     // Checked lines whose compiled instructions were overwritten
 
-        bool m_IsValid {false}; // Indicates if the Chip8 instance is valid
+        bool     m_IsValid {false};   // Indicates if the Chip8 instance is valid
+        uint32_t m_StalledCycles {0}; // Cycles of the current emulateCycles() call that ran no instruction
     };
 } // namespace chip8cpp
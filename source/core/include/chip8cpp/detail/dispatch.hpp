@@ -0,0 +1,292 @@
+#pragma once
+
+#include "chip8cpp/detail/instructions.hpp"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace chip8cpp::detail
+{
+    // The interpreter dispatches an opcode with two loads: its index in a table of the distinct handlers, then the
+    // handler. A table of handler pointers for all 65,536 opcodes would need a relocation per entry in a shared
+    // library, and is too large to fill at compile time on every compiler. Shared with chip8cpp-bench, not a stable
+    // API.
+
+    // Handlers without a register operand, their index is their value
+    enum class FixedHandler : uint16_t
+    {
+        eTrapUnknownOpcode = 0,
+        eClearScreen,
+        eReturnFromSubroutine,
+        eJump,
+        eCall,
+        eSetIndex,
+        eJumpOffset,
+        eDraw,
+        eCount,
+    };
+
+    // Handlers with an X operand, 16 indices each after the fixed handlers
+    enum class XHandler : uint16_t
+    {
+        eSkipIfEqualImmediate = 0,
+        eSkipIfNotEqualImmediate,
+        eSetImmediate,
+        eAddImmediate,
+        eRandom,
+        eSkipIfKeyPressed,
+        eSkipIfKeyNotPressed,
+        eGetDelayTimer,
+        eWaitForKey,
+        eSetDelayTimer,
+        eSetSoundTimer,
+        eAddToIndex,
+        eSetIndexToDigit,
+        eStoreBCD,
+        eStoreRegisters,
+        eLoadRegisters,
+        eCount,
+    };
+
+    // Handlers with X and Y operands, 256 indices each after the X handlers
+    enum class XYHandler : uint16_t
+    {
+        eSkipIfEqual = 0,
+        eSet,
+        eBitwiseOr,
+        eBitwiseAnd,
+        eBitwiseXor,
+        eAdd,
+        eSubtract,
+        eShiftRight,
+        eSubtractReversed,
+        eShiftLeft,
+        eSkipIfNotEqual,
+        eCount,
+    };
+
+    constexpr size_t XHandlerBase  = static_cast<size_t>(FixedHandler::eCount);
+    constexpr size_t XYHandlerBase = XHandlerBase + static_cast<size_t>(XHandler::eCount) * 16;
+    constexpr size_t HandlerCount  = XYHandlerBase + static_cast<size_t>(XYHandler::eCount) * 256;
+
+    static_assert(HandlerCount <= 0x10000); // Indices are 16 bits
+
+    constexpr uint16_t getHandlerIndex(FixedHandler handler) { return static_cast<uint16_t>(handler); }
+
+    constexpr uint16_t getHandlerIndex(XHandler handler, size_t x)
+    {
+        return static_cast<uint16_t>(XHandlerBase + static_cast<size_t>(handler) * 16 + x);
+    }
+
+    constexpr uint16_t getHandlerIndex(XYHandler handler, size_t xy)
+    {
+        return static_cast<uint16_t>(XYHandlerBase + static_cast<size_t>(handler) * 256 + xy);
+    }
+
+    // Handler instantiations for every X, or every X and Y with X in the high nibble of the index
+    template <typename MakeHandler, size_t... X>
+    constexpr std::array<Handler, sizeof...(X)> makeHandlers(MakeHandler makeHandler, std::index_sequence<X...>)
+    {
+        return {makeHandler.template operator()<static_cast<uint8_t>(X)>()...};
+    }
+
+    template <typename MakeHandler, size_t... XY>
+    constexpr std::array<Handler, sizeof...(XY)> makeXYHandlers(MakeHandler makeHandler, std::index_sequence<XY...>)
+    {
+        return {makeHandler.template operator()<static_cast<uint8_t>(XY >> 4), static_cast<uint8_t>(XY & 0xF)>()...};
+    }
+
+#define CHIP8CPP_X_HANDLERS(handler) \
+    makeHandlers([]<uint8_t X>() -> Handler { return &handler; }, std::make_index_sequence<16> {})
+#define CHIP8CPP_XY_HANDLERS(handler) \
+    makeXYHandlers([]<uint8_t X, uint8_t Y>() -> Handler { return &handler; }, std::make_index_sequence<256> {})
+
+    // Every distinct handler, in index order
+    template <typename Hooks>
+    constexpr std::array<Handler, HandlerCount> makeHandlerTable()
+    {
+        std::array<Handler, HandlerCount> table {};
+
+        const auto setFixed = [&table](FixedHandler handler, Handler function)
+        { table[getHandlerIndex(handler)] = function; };
+        const auto setX = [&table](XHandler handler, const std::array<Handler, 16>& functions)
+        {
+            for (size_t x = 0; x < functions.size(); ++x)
+            {
+                table[getHandlerIndex(handler, x)] = functions[x];
+            }
+        };
+        const auto setXY = [&table](XYHandler handler, const std::array<Handler, 256>& functions)
+        {
+            for (size_t xy = 0; xy < functions.size(); ++xy)
+            {
+                table[getHandlerIndex(handler, xy)] = functions[xy];
+            }
+        };
+
+        setFixed(FixedHandler::eTrapUnknownOpcode, &Instructions::trapUnknownOpcode);
+        setFixed(FixedHandler::eClearScreen, &Instructions::clearScreen);
+        setFixed(FixedHandler::eReturnFromSubroutine, &Instructions::returnFromSubroutine);
+        setFixed(FixedHandler::eJump, &Instructions::jump);
+        setFixed(FixedHandler::eCall, &Instructions::call);
+        setFixed(FixedHandler::eSetIndex, &Instructions::setIndex);
+        setFixed(FixedHandler::eJumpOffset, &Instructions::jumpOffset);
+        setFixed(FixedHandler::eDraw, &Instructions::draw<Hooks>);
+
+        setX(XHandler::eSkipIfEqualImmediate, CHIP8CPP_X_HANDLERS(Instructions::skipIfEqualImmediate<X>));
+        setX(XHandler::eSkipIfNotEqualImmediate, CHIP8CPP_X_HANDLERS(Instructions::skipIfNotEqualImmediate<X>));
+        setX(XHandler::eSetImmediate, CHIP8CPP_X_HANDLERS(Instructions::setImmediate<X>));
+        setX(XHandler::eAddImmediate, CHIP8CPP_X_HANDLERS(Instructions::addImmediate<X>));
+        setX(XHandler::eRandom, CHIP8CPP_X_HANDLERS(Instructions::random<X>));
+        setX(XHandler::eSkipIfKeyPressed, CHIP8CPP_X_HANDLERS(Instructions::skipIfKeyPressed<X>));
+        setX(XHandler::eSkipIfKeyNotPressed, CHIP8CPP_X_HANDLERS(Instructions::skipIfKeyNotPressed<X>));
+        setX(XHandler::eGetDelayTimer, CHIP8CPP_X_HANDLERS(Instructions::getDelayTimer<X>));
+        setX(XHandler::eWaitForKey, CHIP8CPP_X_HANDLERS(Instructions::waitForKey<X>));
+        setX(XHandler::eSetDelayTimer, CHIP8CPP_X_HANDLERS(Instructions::setDelayTimer<X>));
+        setX(XHandler::eSetSoundTimer, CHIP8CPP_X_HANDLERS(Instructions::setSoundTimer<X>));
+        setX(XHandler::eAddToIndex, CHIP8CPP_X_HANDLERS(Instructions::addToIndex<X>));
+        setX(XHandler::eSetIndexToDigit, CHIP8CPP_X_HANDLERS(Instructions::setIndexToDigit<X>));
+        setX(XHandler::eStoreBCD, CHIP8CPP_X_HANDLERS((Instructions::storeBCD<Hooks, X>)));
+        setX(XHandler::eStoreRegisters, CHIP8CPP_X_HANDLERS((Instructions::storeRegisters<Hooks, X>)));
+        setX(XHandler::eLoadRegisters, CHIP8CPP_X_HANDLERS((Instructions::loadRegisters<Hooks, X>)));
+
+        setXY(XYHandler::eSkipIfEqual, CHIP8CPP_XY_HANDLERS((Instructions::skipIfEqual<X, Y>)));
+        setXY(XYHandler::eSet, CHIP8CPP_XY_HANDLERS((Instructions::set<X, Y>)));
+        setXY(XYHandler::eBitwiseOr, CHIP8CPP_XY_HANDLERS((Instructions::bitwiseOr<X, Y>)));
+        setXY(XYHandler::eBitwiseAnd, CHIP8CPP_XY_HANDLERS((Instructions::bitwiseAnd<X, Y>)));
+        setXY(XYHandler::eBitwiseXor, CHIP8CPP_XY_HANDLERS((Instructions::bitwiseXor<X, Y>)));
+        setXY(XYHandler::eAdd, CHIP8CPP_XY_HANDLERS((Instructions::add<X, Y>)));
+        setXY(XYHandler::eSubtract, CHIP8CPP_XY_HANDLERS((Instructions::subtract<X, Y>)));
+        setXY(XYHandler::eShiftRight, CHIP8CPP_XY_HANDLERS((Instructions::shiftRight<X, Y>)));
+        setXY(XYHandler::eSubtractReversed, CHIP8CPP_XY_HANDLERS((Instructions::subtractReversed<X, Y>)));
+        setXY(XYHandler::eShiftLeft, CHIP8CPP_XY_HANDLERS((Instructions::shiftLeft<X, Y>)));
+        setXY(XYHandler::eSkipIfNotEqual, CHIP8CPP_XY_HANDLERS((Instructions::skipIfNotEqual<X, Y>)));
+
+        return table;
+    }
+
+#undef CHIP8CPP_X_HANDLERS
+#undef CHIP8CPP_XY_HANDLERS
+
+    // One table per hook policy, the memory instructions are the only handlers that differ
+    template <typename Hooks>
+    constexpr std::array<Handler, HandlerCount> HandlerTable = makeHandlerTable<Hooks>();
+
+    // Handler index of an opcode, mirroring the masks the instructions are decoded with
+    constexpr uint16_t selectHandlerIndex(uint16_t opcode)
+    {
+        const size_t x  = (opcode & 0x0F00) >> 8;
+        const size_t xy = (opcode & 0x0FF0) >> 4;
+
+        switch (opcode & 0xF000)
+        {
+            case 0x0000:
+                switch (opcode & 0x00FF)
+                {
+                    case 0x00E0:
+                        return getHandlerIndex(FixedHandler::eClearScreen);
+                    case 0x00EE:
+                        return getHandlerIndex(FixedHandler::eReturnFromSubroutine);
+                    default:
+                        return getHandlerIndex(FixedHandler::eTrapUnknownOpcode);
+                }
+            case 0x1000:
+                return getHandlerIndex(FixedHandler::eJump);
+            case 0x2000:
+                return getHandlerIndex(FixedHandler::eCall);
+            case 0x3000:
+                return getHandlerIndex(XHandler::eSkipIfEqualImmediate, x);
+            case 0x4000:
+                return getHandlerIndex(XHandler::eSkipIfNotEqualImmediate, x);
+            case 0x5000:
+                return getHandlerIndex(XYHandler::eSkipIfEqual, xy);
+            case 0x6000:
+                return getHandlerIndex(XHandler::eSetImmediate, x);
+            case 0x7000:
+                return getHandlerIndex(XHandler::eAddImmediate, x);
+            case 0x8000:
+                switch (opcode & 0x000F)
+                {
+                    case 0x0000:
+                        return getHandlerIndex(XYHandler::eSet, xy);
+                    case 0x0001:
+                        return getHandlerIndex(XYHandler::eBitwiseOr, xy);
+                    case 0x0002:
+                        return getHandlerIndex(XYHandler::eBitwiseAnd, xy);
+                    case 0x0003:
+                        return getHandlerIndex(XYHandler::eBitwiseXor, xy);
+                    case 0x0004:
+                        return getHandlerIndex(XYHandler::eAdd, xy);
+                    case 0x0005:
+                        return getHandlerIndex(XYHandler::eSubtract, xy);
+                    case 0x0006:
+                        return getHandlerIndex(XYHandler::eShiftRight, xy);
+                    case 0x0007:
+                        return getHandlerIndex(XYHandler::eSubtractReversed, xy);
+                    case 0x000E:
+                        return getHandlerIndex(XYHandler::eShiftLeft, xy);
+                    default:
+                        return getHandlerIndex(FixedHandler::eTrapUnknownOpcode);
+                }
+            case 0x9000:
+                return getHandlerIndex(XYHandler::eSkipIfNotEqual, xy);
+            case 0xA000:
+                return getHandlerIndex(FixedHandler::eSetIndex);
+            case 0xB000:
+                return getHandlerIndex(FixedHandler::eJumpOffset);
+            case 0xC000:
+                return getHandlerIndex(XHandler::eRandom, x);
+            case 0xD000:
+                return getHandlerIndex(FixedHandler::eDraw);
+            case 0xE000:
+                switch (opcode & 0x00FF)
+                {
+                    case 0x009E:
+                        return getHandlerIndex(XHandler::eSkipIfKeyPressed, x);
+                    case 0x00A1:
+                        return getHandlerIndex(XHandler::eSkipIfKeyNotPressed, x);
+                    default:
+                        return getHandlerIndex(FixedHandler::eTrapUnknownOpcode);
+                }
+            default: // 0xF000
+                switch (opcode & 0x00FF)
+                {
+                    case 0x0007:
+                        return getHandlerIndex(XHandler::eGetDelayTimer, x);
+                    case 0x000A:
+                        return getHandlerIndex(XHandler::eWaitForKey, x);
+                    case 0x0015:
+                        return getHandlerIndex(XHandler::eSetDelayTimer, x);
+                    case 0x0018:
+                        return getHandlerIndex(XHandler::eSetSoundTimer, x);
+                    case 0x001E:
+                        return getHandlerIndex(XHandler::eAddToIndex, x);
+                    case 0x0029:
+                        return getHandlerIndex(XHandler::eSetIndexToDigit, x);
+                    case 0x0033:
+                        return getHandlerIndex(XHandler::eStoreBCD, x);
+                    case 0x0055:
+                        return getHandlerIndex(XHandler::eStoreRegisters, x);
+                    case 0x0065:
+                        return getHandlerIndex(XHandler::eLoadRegisters, x);
+                    default:
+                        return getHandlerIndex(FixedHandler::eTrapUnknownOpcode);
+                }
+        }
+    }
+
+    using DispatchIndex = std::array<uint16_t, 0x10000>;
+
+    // Handler index of every opcode. Filled at run time, evaluating 65,536 opcodes at compile time exceeds MSVC's
+    // constexpr step limit and comes close to Clang's.
+    inline DispatchIndex makeDispatchIndex()
+    {
+        DispatchIndex index {};
+        for (size_t opcode = 0; opcode < index.size(); ++opcode)
+        {
+            index[opcode] = selectHandlerIndex(static_cast<uint16_t>(opcode));
+        }
+        return index;
+    }
+} // namespace chip8cpp::detail
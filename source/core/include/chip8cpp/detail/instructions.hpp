@@ -0,0 +1,611 @@
+#pragma once
+
+#include "chip8cpp/chip8cpp.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+namespace chip8cpp::detail
+{
+    // Hook policies the interpreter is instantiated with, the debugger checks compile away entirely without one
+    struct NoHooks
+    {
+        static constexpr bool IsDebugging = false;
+    };
+
+    struct DebuggerHooks
+    {
+        static constexpr bool IsDebugging = true;
+    };
+
+    // Called with the interpreter and the opcode, which only handlers with an NN or NNN operand still decode
+    using Handler = void (*)(Chip8& chip8, uint16_t opcode);
+
+    // Instruction handlers, one per instruction and register operand where X and Y are template parameters, so the
+    // register accesses compile to fixed offsets. Sprite drawing keeps its operands at runtime, its loop dominates.
+    // Shared by the interpreter's dispatch table and the code generated by chip8cpp-aot, not a stable API.
+    // https://en.wikipedia.org/wiki/CHIP-8
+    // https://tobiasvl.github.io/blog/write-a-chip-8-emulator/#instructions
+    // https://chip8.gulrak.net/
+    struct Instructions
+    {
+        static constexpr uint64_t PixelMask = 0x8000000000000000; // Bit of the leftmost pixel in a graphics row
+
+        // Ends the cycle of every instruction, like Chip8::emulateOneCycle() does, inline while both timers are idle
+        static void endCycle(Chip8& chip8)
+        {
+            if (chip8.m_DelayTimer != 0 || chip8.m_SoundTimer != 0)
+            {
+                chip8.updateTimers();
+            }
+        }
+
+        // Where the instruction that just ran continued, for compiled code following skips and waits
+        static uint16_t getPC(const Chip8& chip8) { return chip8.m_PC; }
+
+        static void trapUnknownOpcode(Chip8& chip8, uint16_t opcode)
+        {
+            chip8.raiseTrap(Trap::eUnknownOpcode, opcode); // The PC stays on the opcode
+        }
+
+        // 0x00E0: Clear the display
+        static void clearScreen(Chip8& chip8, uint16_t)
+        {
+            std::ranges::fill(chip8.m_GFX, 0);
+            chip8.m_DirtyRows = ~uint32_t {0};
+            chip8.m_DrawFlag  = true;
+            chip8.m_PC += 2;
+        }
+
+        // 0x00EE: Return from subroutine
+        static void returnFromSubroutine(Chip8& chip8, uint16_t opcode)
+        {
+            if (chip8.m_SP == 0)
+            {
+                chip8.raiseTrap(Trap::eStackUnderflow, opcode);
+                return;
+            }
+            chip8.m_PC = chip8.m_Stack[--chip8.m_SP] + 2; // Pop from stack and set PC
+        }
+
+        // 0x1NNN: Jump to address NNN
+        static void jump(Chip8& chip8, uint16_t opcode) { chip8.m_PC = opcode & 0x0FFF; }
+
+        // 0x2NNN: Call subroutine at NNN
+        static void call(Chip8& chip8, uint16_t opcode)
+        {
+            if (chip8.m_SP == constants::StackSize)
+            {
+                chip8.raiseTrap(Trap::eStackOverflow, opcode);
+                return;
+            }
+            chip8.m_Stack[chip8.m_SP++] = chip8.m_PC;      // Push current PC onto stack
+            chip8.m_PC                  = opcode & 0x0FFF; // Set PC to NNN
+        }
+
+        // 0x3XNN: Skip next instruction if VX == NN
+        template <uint8_t X>
+        static void skipIfEqualImmediate(Chip8& chip8, uint16_t opcode)
+        {
+            chip8.m_PC += chip8.m_V[X] == (opcode & 0x00FF) ? 4 : 2;
+        }
+
+        // 0x4XNN: Skip next instruction if VX != NN
+        template <uint8_t X>
+        static void skipIfNotEqualImmediate(Chip8& chip8, uint16_t opcode)
+        {
+            chip8.m_PC += chip8.m_V[X] != (opcode & 0x00FF) ? 4 : 2;
+        }
+
+        // 0x5XY0: Skip next instruction if VX == VY
+        template <uint8_t X, uint8_t Y>
+        static void skipIfEqual(Chip8& chip8, uint16_t)
+        {
+            chip8.m_PC += chip8.m_V[X] == chip8.m_V[Y] ? 4 : 2;
+        }
+
+        // 0x6XNN: Set register VX to NN
+        template <uint8_t X>
+        static void setImmediate(Chip8& chip8, uint16_t opcode)
+        {
+            chip8.m_V[X] = opcode & 0x00FF;
+            chip8.m_PC += 2;
+        }
+
+        // 0x7XNN: Add NN to register VX
+        template <uint8_t X>
+        static void addImmediate(Chip8& chip8, uint16_t opcode)
+        {
+            chip8.m_V[X] += opcode & 0x00FF;
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY0: Set VX to VY
+        template <uint8_t X, uint8_t Y>
+        static void set(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[X] = chip8.m_V[Y];
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY1: Set VX to VX OR VY
+        template <uint8_t X, uint8_t Y>
+        static void bitwiseOr(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[X] |= chip8.m_V[Y];
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY2: Set VX to VX AND VY
+        template <uint8_t X, uint8_t Y>
+        static void bitwiseAnd(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[X] &= chip8.m_V[Y];
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY3: Set VX to VX XOR VY
+        template <uint8_t X, uint8_t Y>
+        static void bitwiseXor(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[X] ^= chip8.m_V[Y];
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY4: Add VY to VX, set VF if carry
+        template <uint8_t X, uint8_t Y>
+        static void add(Chip8& chip8, uint16_t)
+        {
+            uint16_t sum   = chip8.m_V[X] + chip8.m_V[Y];
+            chip8.m_V[0xF] = (sum > 255) ? 1 : 0; // Set carry flag
+            chip8.m_V[X]   = sum & 0xFF;          // Store result in VX
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY5: Subtract VY from VX, set VF if no borrow
+        template <uint8_t X, uint8_t Y>
+        static void subtract(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[0xF] = (chip8.m_V[Y] <= chip8.m_V[X]) ? 1 : 0;
+            chip8.m_V[X] -= chip8.m_V[Y];
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY6: Shift VX right by 1, set VF to LSB
+        template <uint8_t X, uint8_t Y>
+        static void shiftRight(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[0xF] = chip8.m_V[X] & 0x01; // Store LSB in VF
+            chip8.m_V[X] >>= 1;                   // Shift right
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XY7: Set VX to VY - VX, set VF if no borrow
+        template <uint8_t X, uint8_t Y>
+        static void subtractReversed(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[0xF] = (chip8.m_V[X] <= chip8.m_V[Y]) ? 1 : 0;
+            chip8.m_V[X]   = chip8.m_V[Y] - chip8.m_V[X];
+            chip8.m_PC += 2;
+        }
+
+        // 0x8XYE: Shift VX left by 1, set VF to MSB
+        template <uint8_t X, uint8_t Y>
+        static void shiftLeft(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[0xF] = (chip8.m_V[X] & 0x80) >> 7; // Store MSB in VF
+            chip8.m_V[X] <<= 1;                          // Shift left
+            chip8.m_PC += 2;
+        }
+
+        // 0x9XY0: Skip next instruction if VX != VY
+        template <uint8_t X, uint8_t Y>
+        static void skipIfNotEqual(Chip8& chip8, uint16_t)
+        {
+            chip8.m_PC += chip8.m_V[X] != chip8.m_V[Y] ? 4 : 2;
+        }
+
+        // 0xANNN: Set index register I to NNN
+        static void setIndex(Chip8& chip8, uint16_t opcode)
+        {
+            chip8.m_I = opcode & 0x0FFF;
+            chip8.m_PC += 2;
+        }
+
+        // 0xBNNN: Jump to address NNN + V0
+        static void jumpOffset(Chip8& chip8, uint16_t opcode) { chip8.m_PC = (opcode & 0x0FFF) + chip8.m_V[0]; }
+
+        // 0xCXNN: Set VX to random byte AND NN
+        template <uint8_t X>
+        static void random(Chip8& chip8, uint16_t opcode)
+        {
+            uint8_t randomByte = chip8.nextRandomByte();
+            chip8.m_V[X]       = randomByte & (opcode & 0x00FF);
+            chip8.m_PC += 2;
+        }
+
+        // 0xDXYN: Draw sprite at (VX, VY) with height N
+        template <typename Hooks>
+        static void draw(Chip8& chip8, uint16_t opcode)
+        {
+            uint8_t x      = chip8.m_V[(opcode & 0x0F00) >> 8];
+            uint8_t y      = chip8.m_V[(opcode & 0x00F0) >> 4];
+            uint8_t height = opcode & 0x000F;
+            if (!checkIndexRange(chip8, opcode, height))
+            {
+                return;
+            }
+            chip8.m_V[0xF] = 0; // Clear collision flag
+
+            for (uint8_t row = 0; row < height; ++row)
+            {
+                uint8_t pixel = loadByte<Hooks>(chip8, chip8.m_I + row);
+                for (uint8_t col = 0; col < 8; ++col)
+                {
+                    if ((pixel & (0x80 >> col)) != 0)
+                    {
+                        size_t    gfxIndex    = (x + col + (y + row) * constants::Width) % constants::GfxSize;
+                        size_t    gfxRowIndex = gfxIndex / constants::Width;
+                        uint64_t& gfxRow      = chip8.m_GFX[gfxRowIndex];
+                        uint64_t  mask        = PixelMask >> (gfxIndex % constants::Width);
+                        if ((gfxRow & mask) != 0)
+                            chip8.m_V[0xF] = 1; // Collision detected
+                        gfxRow ^= mask;         // Toggle pixel
+                        chip8.m_DirtyRows |= uint32_t {1} << gfxRowIndex;
+                    }
+                }
+            }
+            chip8.m_DrawFlag = true;
+            chip8.m_PC += 2;
+        }
+
+        // 0xEX9E: Skip next instruction if key VX is pressed
+        template <uint8_t X>
+        static void skipIfKeyPressed(Chip8& chip8, uint16_t)
+        {
+            chip8.m_PC += chip8.isKeyPressed(static_cast<KeyCode>(chip8.m_V[X])) ? 4 : 2;
+        }
+
+        // 0xEXA1: Skip next instruction if key VX is not pressed
+        template <uint8_t X>
+        static void skipIfKeyNotPressed(Chip8& chip8, uint16_t)
+        {
+            chip8.m_PC += !chip8.isKeyPressed(static_cast<KeyCode>(chip8.m_V[X])) ? 4 : 2;
+        }
+
+        // 0xFX07: Set VX to delay timer value
+        template <uint8_t X>
+        static void getDelayTimer(Chip8& chip8, uint16_t)
+        {
+            chip8.m_V[X] = chip8.m_DelayTimer;
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX0A: Wait for key press, store in VX
+        template <uint8_t X>
+        static void waitForKey(Chip8& chip8, uint16_t)
+        {
+            for (size_t i = 0; i < constants::KeyCount; ++i)
+            {
+                if (chip8.isKeyPressed(static_cast<KeyCode>(i)))
+                {
+                    chip8.m_V[X] = static_cast<uint8_t>(i);
+                    chip8.m_PC += 2;
+                    return;
+                }
+            }
+            // No key pressed, run this instruction again
+        }
+
+        // 0xFX15: Set delay timer to VX
+        template <uint8_t X>
+        static void setDelayTimer(Chip8& chip8, uint16_t)
+        {
+            chip8.m_DelayTimer = chip8.m_V[X];
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX18: Set sound timer to VX
+        template <uint8_t X>
+        static void setSoundTimer(Chip8& chip8, uint16_t)
+        {
+            chip8.m_SoundTimer = chip8.m_V[X];
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX1E: Add VX to I
+        template <uint8_t X>
+        static void addToIndex(Chip8& chip8, uint16_t)
+        {
+            chip8.m_I += chip8.m_V[X];
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX29: Set I to the location of the sprite for digit VX
+        template <uint8_t X>
+        static void setIndexToDigit(Chip8& chip8, uint16_t)
+        {
+            uint8_t digit = chip8.m_V[X];
+            if (digit < constants::FontSetSize / constants::FontHeight)
+                chip8.m_I = digit * constants::FontHeight; // Each font character is stored in memory sequentially
+            else
+                std::cerr << "Invalid digit for sprite location." << std::endl;
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX33: Store BCD representation of VX in memory at I
+        template <typename Hooks, uint8_t X>
+        static void storeBCD(Chip8& chip8, uint16_t opcode)
+        {
+            if (!checkIndexRange(chip8, opcode, 3))
+            {
+                return;
+            }
+            uint8_t value = chip8.m_V[X];
+            storeByte<Hooks>(chip8, chip8.m_I, value / 100);           // Hundreds digit
+            storeByte<Hooks>(chip8, chip8.m_I + 1, (value / 10) % 10); // Tens digit
+            storeByte<Hooks>(chip8, chip8.m_I + 2, value % 10);        // Ones digit
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX55: Store registers V0 to VX in memory starting at I
+        template <typename Hooks, uint8_t X>
+        static void storeRegisters(Chip8& chip8, uint16_t opcode)
+        {
+            if (!checkIndexRange(chip8, opcode, X + 1))
+            {
+                return;
+            }
+            for (uint8_t i = 0; i <= X; ++i)
+            {
+                storeByte<Hooks>(chip8, chip8.m_I + i, chip8.m_V[i]);
+            }
+            chip8.m_I += X + 1; // Move I forward by the number of registers stored
+            chip8.m_PC += 2;
+        }
+
+        // 0xFX65: Read registers V0 to VX from memory starting at I
+        template <typename Hooks, uint8_t X>
+        static void loadRegisters(Chip8& chip8, uint16_t opcode)
+        {
+            if (!checkIndexRange(chip8, opcode, X + 1))
+            {
+                return;
+            }
+            for (uint8_t i = 0; i <= X; ++i)
+            {
+                chip8.m_V[i] = loadByte<Hooks>(chip8, chip8.m_I + i);
+            }
+            chip8.m_I += X + 1; // Move I forward by the number of registers read
+            chip8.m_PC += 2;
+        }
+
+        // The interpreter before the dispatch table and the hook policies: one two-level switch with the
+        // instructions inline and their registers decoded at run time. Only chip8cpp-bench instantiates it, as the
+        // baseline the dispatch and hooks benchmarks compare against.
+        static void executeBySwitch(Chip8& chip8, uint16_t opcode)
+        {
+            const uint8_t x  = (opcode & 0x0F00) >> 8;
+            uint8_t&      vx = chip8.m_V[x];
+            uint8_t&      vy = chip8.m_V[(opcode & 0x00F0) >> 4];
+            uint8_t&      vf = chip8.m_V[0xF];
+
+            switch (opcode & 0xF000)
+            {
+                case 0x0000:
+                    switch (opcode & 0x00FF)
+                    {
+                        case 0x00E0:
+                            clearScreen(chip8, opcode);
+                            return;
+                        case 0x00EE:
+                            returnFromSubroutine(chip8, opcode);
+                            return;
+                        default:
+                            trapUnknownOpcode(chip8, opcode);
+                            return;
+                    }
+                case 0x1000:
+                    chip8.m_PC = opcode & 0x0FFF;
+                    return;
+                case 0x2000:
+                    call(chip8, opcode);
+                    return;
+                case 0x3000:
+                    chip8.m_PC += vx == (opcode & 0x00FF) ? 4 : 2;
+                    return;
+                case 0x4000:
+                    chip8.m_PC += vx != (opcode & 0x00FF) ? 4 : 2;
+                    return;
+                case 0x5000:
+                    chip8.m_PC += vx == vy ? 4 : 2;
+                    return;
+                case 0x6000:
+                    vx = opcode & 0x00FF;
+                    chip8.m_PC += 2;
+                    return;
+                case 0x7000:
+                    vx += opcode & 0x00FF;
+                    chip8.m_PC += 2;
+                    return;
+                case 0x8000:
+                    switch (opcode & 0x000F)
+                    {
+                        case 0x0000:
+                            vx = vy;
+                            break;
+                        case 0x0001:
+                            vx |= vy;
+                            break;
+                        case 0x0002:
+                            vx &= vy;
+                            break;
+                        case 0x0003:
+                            vx ^= vy;
+                            break;
+                        case 0x0004:
+                        {
+                            uint16_t sum = vx + vy;
+                            vf           = (sum > 255) ? 1 : 0;
+                            vx           = sum & 0xFF;
+                            break;
+                        }
+                        case 0x0005:
+                            vf = (vy <= vx) ? 1 : 0;
+                            vx -= vy;
+                            break;
+                        case 0x0006:
+                            vf = vx & 0x01;
+                            vx >>= 1;
+                            break;
+                        case 0x0007:
+                            vf = (vx <= vy) ? 1 : 0;
+                            vx = vy - vx;
+                            break;
+                        case 0x000E:
+                            vf = (vx & 0x80) >> 7;
+                            vx <<= 1;
+                            break;
+                        default:
+                            trapUnknownOpcode(chip8, opcode);
+                            return;
+                    }
+                    chip8.m_PC += 2;
+                    return;
+                case 0x9000:
+                    chip8.m_PC += vx != vy ? 4 : 2;
+                    return;
+                case 0xA000:
+                    chip8.m_I = opcode & 0x0FFF;
+                    chip8.m_PC += 2;
+                    return;
+                case 0xB000:
+                    chip8.m_PC = (opcode & 0x0FFF) + chip8.m_V[0];
+                    return;
+                case 0xC000:
+                    vx = chip8.nextRandomByte() & (opcode & 0x00FF);
+                    chip8.m_PC += 2;
+                    return;
+                case 0xD000:
+                    draw<NoHooks>(chip8, opcode);
+                    return;
+                case 0xE000:
+                    switch (opcode & 0x00FF)
+                    {
+                        case 0x009E:
+                            chip8.m_PC += chip8.isKeyPressed(static_cast<KeyCode>(vx)) ? 4 : 2;
+                            return;
+                        case 0x00A1:
+                            chip8.m_PC += !chip8.isKeyPressed(static_cast<KeyCode>(vx)) ? 4 : 2;
+                            return;
+                        default:
+                            trapUnknownOpcode(chip8, opcode);
+                            return;
+                    }
+                default: // 0xF000
+                    switch (opcode & 0x00FF)
+                    {
+                        case 0x0007:
+                            vx = chip8.m_DelayTimer;
+                            break;
+                        case 0x000A:
+                            for (size_t i = 0; i < constants::KeyCount; ++i)
+                            {
+                                if (chip8.isKeyPressed(static_cast<KeyCode>(i)))
+                                {
+                                    vx = static_cast<uint8_t>(i);
+                                    chip8.m_PC += 2;
+                                    return;
+                                }
+                            }
+                            return;
+                        case 0x0015:
+                            chip8.m_DelayTimer = vx;
+                            break;
+                        case 0x0018:
+                            chip8.m_SoundTimer = vx;
+                            break;
+                        case 0x001E:
+                            chip8.m_I += vx;
+                            break;
+                        case 0x0029:
+                            if (vx < constants::FontSetSize / constants::FontHeight)
+                                chip8.m_I = vx * constants::FontHeight;
+                            else
+                                std::cerr << "Invalid digit for sprite location." << std::endl;
+                            break;
+                        case 0x0033:
+                            if (!checkIndexRange(chip8, opcode, 3))
+                            {
+                                return;
+                            }
+                            chip8.writeMemory(chip8.m_I, vx / 100);
+                            chip8.writeMemory(chip8.m_I + 1, (vx / 10) % 10);
+                            chip8.writeMemory(chip8.m_I + 2, vx % 10);
+                            break;
+                        case 0x0055:
+                            if (!checkIndexRange(chip8, opcode, x + 1))
+                            {
+                                return;
+                            }
+                            for (uint8_t i = 0; i <= x; ++i)
+                            {
+                                chip8.writeMemory(chip8.m_I + i, chip8.m_V[i]);
+                            }
+                            chip8.m_I += x + 1;
+                            break;
+                        case 0x0065:
+                            if (!checkIndexRange(chip8, opcode, x + 1))
+                            {
+                                return;
+                            }
+                            for (uint8_t i = 0; i <= x; ++i)
+                            {
+                                chip8.m_V[i] = chip8.readMemory(chip8.m_I + i);
+                            }
+                            chip8.m_I += x + 1;
+                            break;
+                        default:
+                            trapUnknownOpcode(chip8, opcode);
+                            return;
+                    }
+                    chip8.m_PC += 2;
+                    return;
+            }
+        }
+
+        // Traps instead of wrapping around when an instruction would access memory past the end from I
+        static bool checkIndexRange(Chip8& chip8, uint16_t opcode, size_t size)
+        {
+            if (chip8.m_I + size > constants::MemorySize)
+            {
+                chip8.raiseTrap(Trap::eMemoryOutOfBounds, opcode);
+                return false;
+            }
+            return true;
+        }
+
+        // Data accesses of instructions, which carry the debugger's watchpoint checks when it is attached
+        template <typename Hooks>
+        static uint8_t loadByte(Chip8& chip8, uint16_t address)
+        {
+            const uint8_t value = chip8.readMemory(address);
+            if constexpr (Hooks::IsDebugging)
+            {
+                chip8.m_Debugger->checkRead(address, chip8.m_PC);
+            }
+            return value;
+        }
+
+        template <typename Hooks>
+        static void storeByte(Chip8& chip8, uint16_t address, uint8_t value)
+        {
+            chip8.writeMemory(address, value);
+            if constexpr (Hooks::IsDebugging)
+            {
+                chip8.m_Debugger->checkWrite(address, chip8.m_PC);
+            }
+        }
+    };
+} // namespace chip8cpp::detail
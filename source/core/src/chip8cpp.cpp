@@ -1,117 +1,228 @@
 #include "chip8cpp/chip8cpp.hpp"
+#include "chip8cpp/detail/dispatch.hpp"
+#include "chip8cpp/detail/instructions.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
-#include <fstream>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <utility>
 
 namespace
 {
-    const uint8_t FontSet[chip8cpp::constants::FontSetSize] = {
-        // Fontset data (0x0 to 0xF)
-        0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
-        0x20, 0x60, 0x20, 0x20, 0x70, // 1
-        0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
-        0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
-        0x90, 0x90, 0xF0, 0x10, 0x10, // 4
-        0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
-        0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
-        0xF0, 0x10, 0x20, 0x40, 0x40, // 7
-        0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
-        0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
-        0xF0, 0x90, 0xF0, 0x90, 0x90, // A
-        0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
-        0xF0, 0x80, 0x80, 0x80, 0xF0, // C
-        0xE0, 0x90, 0x90, 0x90, 0xE0, // D
-        0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
-        0xF0, 0x80, 0xF0, 0x80, 0x80  // F
+    // Finalizer of SplitMix64, spreads every input bit over the whole hash
+    constexpr uint64_t mixHash(uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+
+    // Hash of a byte at an address, memory is hashed as the XOR of these for every byte that differs from the image
+    constexpr uint64_t hashMemoryByte(uint16_t address, uint8_t value)
+    {
+        return mixHash((uint64_t {address} << 8 | value) + 0x9E3779B97F4A7C15);
+    }
+
+    constexpr uint64_t PixelMask = 0x8000000000000000; // Bit of the leftmost pixel in a graphics buffer row
+
+    // Fixed part of a packed checkpoint, the changed graphics rows and memory lines follow it
+    struct PackedFields
+    {
+        uint8_t        V[chip8cpp::constants::RegisterCount];
+        uint16_t       I;
+        uint16_t       PC;
+        uint8_t        SP;
+        uint8_t        delayTimer;
+        uint8_t        soundTimer;
+        bool           drawFlag;
+        bool           isValid;
+        chip8cpp::Trap trap;
+        uint16_t       stack[chip8cpp::constants::StackSize];
+        uint8_t        keys[chip8cpp::constants::KeyCount];
+        uint32_t       randomState;
+        uint32_t       dirtyRows;
+        uint64_t       dirtyLines;
+        uint64_t       memoryHash;
     };
 
-    const char* getKeyCodeName(chip8cpp::KeyCode keyCode)
+    const uint8_t* getImageLine(const chip8cpp::ProgramImage& image, size_t line)
+    {
+        const size_t address = line * chip8cpp::constants::LineSize;
+        return image.getPage(address / chip8cpp::constants::PageSize) + address % chip8cpp::constants::PageSize;
+    }
+
+    // Seed of every load, each one different. The system is only asked once per process, constructing a
+    // std::random_device costs microseconds, several times a whole load. setRandomSeed() mixes the seeds.
+    uint32_t getLoadSeed()
+    {
+        static std::atomic<uint32_t> s_NextSeed {std::random_device {}()};
+        return s_NextSeed.fetch_add(0x9E3779B9, std::memory_order_relaxed);
+    }
+
+    // Handler index of every opcode, one table for both hook policies. Filled on first use, so instances that run
+    // during the static initialization of other translation units never see it zeroed.
+    const chip8cpp::detail::DispatchIndex& getDispatchIndex()
+    {
+        static const chip8cpp::detail::DispatchIndex s_DispatchIndex = chip8cpp::detail::makeDispatchIndex();
+        return s_DispatchIndex;
+    }
+
+    static_assert(chip8cpp::constants::PageCount * chip8cpp::constants::PageSize == chip8cpp::constants::MemorySize);
+    static_assert(chip8cpp::constants::LineCount * chip8cpp::constants::LineSize == chip8cpp::constants::MemorySize);
+    static_assert(chip8cpp::constants::LineCount <= 64); // One bit per line in the dirty line mask
+    static_assert(chip8cpp::constants::Height <= 32);    // One bit per row in the dirty row mask
+} // namespace
+
+namespace chip8cpp
+{
+    const char* getKeyCodeName(KeyCode keyCode)
     {
         switch (keyCode)
         {
-            case chip8cpp::KeyCode::eNum1:
+            case KeyCode::eNum1:
                 return "1";
-            case chip8cpp::KeyCode::eNum2:
+            case KeyCode::eNum2:
                 return "2";
-            case chip8cpp::KeyCode::eNum3:
+            case KeyCode::eNum3:
                 return "3";
-            case chip8cpp::KeyCode::eC:
+            case KeyCode::eC:
                 return "C";
-            case chip8cpp::KeyCode::eNum4:
+            case KeyCode::eNum4:
                 return "4";
-            case chip8cpp::KeyCode::eNum5:
+            case KeyCode::eNum5:
                 return "5";
-            case chip8cpp::KeyCode::eNum6:
+            case KeyCode::eNum6:
                 return "6";
-            case chip8cpp::KeyCode::eD:
+            case KeyCode::eD:
                 return "D";
-            case chip8cpp::KeyCode::eNum7:
+            case KeyCode::eNum7:
                 return "7";
-            case chip8cpp::KeyCode::eNum8:
+            case KeyCode::eNum8:
                 return "8";
-            case chip8cpp::KeyCode::eNum9:
+            case KeyCode::eNum9:
                 return "9";
-            case chip8cpp::KeyCode::eE:
+            case KeyCode::eE:
                 return "E";
-            case chip8cpp::KeyCode::eA:
+            case KeyCode::eA:
                 return "A";
-            case chip8cpp::KeyCode::eNum0:
+            case KeyCode::eNum0:
                 return "0";
-            case chip8cpp::KeyCode::eB:
+            case KeyCode::eB:
                 return "B";
-            case chip8cpp::KeyCode::eF:
+            case KeyCode::eF:
                 return "F";
             default:
                 assert(0);
                 return "";
         }
     }
-} // namespace
 
-namespace chip8cpp
-{
-    Chip8::Chip8(const Config& config) : m_Config(config) {}
+    const char* getTrapName(Trap trap)
+    {
+        switch (trap)
+        {
+            case Trap::eNone:
+                return "No trap";
+            case Trap::eUnknownOpcode:
+                return "Unknown opcode";
+            case Trap::eStackOverflow:
+                return "Stack overflow";
+            case Trap::eStackUnderflow:
+                return "Stack underflow";
+            case Trap::eMemoryOutOfBounds:
+                return "Memory out of bounds";
+            default:
+                assert(0);
+                return "";
+        }
+    }
+
+    Chip8::Chip8(const Config& config) : m_Config(std::make_shared<const Config>(config)) {}
+
+    Chip8::Chip8(std::shared_ptr<const Config> config) { setConfig(std::move(config)); }
+
+    void Chip8::setConfig(const Config& config) { m_Config = std::make_shared<const Config>(config); }
+
+    void Chip8::setConfig(std::shared_ptr<const Config> config)
+    {
+        m_Config = config ? std::move(config) : std::make_shared<const Config>();
+    }
 
-    void          Chip8::setConfig(const Config& config) { m_Config = config; }
-    const Config& Chip8::getConfig() const { return m_Config; }
+    const Config& Chip8::getConfig() const { return *m_Config; }
 
     bool Chip8::loadProgram(const std::string& fileName)
     {
         reset();
 
-        // Load the program into memory starting at 0x200
-        // Read file using C++ file I/O
-        std::ifstream file(fileName, std::ios::binary);
-        if (!file.is_open())
+        std::shared_ptr<const ProgramImage> image = ProgramImage::loadFromFile(fileName);
+        if (!image)
         {
-            return false; // Failed to open the file
+            return false; // Failed to open, read or fit the program
         }
-        file.seekg(0, std::ios::end);
-        size_t fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-        if (fileSize >
-            (constants::MemorySize - constants::ProgramStartAddress)) // 4096 bytes total, 512 bytes reserved for system
+
+#ifdef DEBUG
+        std::cout << "Loaded program: " << fileName << std::endl;
+#endif
+
+        return loadProgram(std::move(image));
+    }
+
+    bool Chip8::loadProgram(std::span<const uint8_t> program)
+    {
+        // Hosts often load from temporary buffers, copying costs about as much as mapping a view
+        return loadProgram(ProgramImage::create(program));
+    }
+
+    bool Chip8::loadProgramView(std::span<const uint8_t> program)
+    {
+        return loadProgram(ProgramImage::createView(program));
+    }
+
+    bool Chip8::loadProgram(const CompiledProgram& program)
+    {
+        // Compiled programs are constant data of the binary
+        if (!loadProgramView(program.program))
         {
-            return false; // Program too large to fit in memory
+            return false;
         }
-        file.read(reinterpret_cast<char*>(&m_Memory[constants::ProgramStartAddress]), fileSize);
-        if (!file)
+
+        // Set after loading, loading resets it
+        m_CompiledProgram = &program;
+        return true;
+    }
+
+    bool Chip8::loadProgram(std::shared_ptr<const ProgramImage> image)
+    {
+        reset();
+
+        if (!image)
         {
-            return false; // Failed to read the file
+            return false;
+        }
+
+        // Seed the random number generator once per load, restart() replays the same sequence
+        setRandomSeed(getLoadSeed());
+
+        // Map every page to the shared image, pages are only copied once the program writes to them
+        m_Image = std::move(image);
+        for (size_t i = 0; i < constants::PageCount; ++i)
+        {
+            m_PageTable[i] = m_Image->getPage(i);
         }
-        file.close();
 
 #ifdef DEBUG
-        std::cout << "Loaded program: " << fileName << std::endl;
-        std::cout << "Program size: " << fileSize << " bytes" << std::endl;
+        const size_t programSize = m_Image->getProgramSize();
+        std::cout << "Program size: " << programSize << " bytes" << std::endl;
         std::cout << "Memory contents after loading program:" << std::endl;
         // Print used memory contents for debugging
-        for (size_t i = constants::ProgramStartAddress; i < constants::ProgramStartAddress + fileSize; ++i)
+        for (size_t i = constants::ProgramStartAddress; i < constants::ProgramStartAddress + programSize; ++i)
         {
-            std::cout << std::format("0x{:02X} ", m_Memory[i]);     // Print each byte in hex format
+            std::cout << std::format("0x{:02X} ", readMemory(i));   // Print each byte in hex format
             if ((i - constants::ProgramStartAddress + 1) % 16 == 0) // New line every 16 bytes
             {
                 std::cout << std::endl;
@@ -131,419 +242,445 @@ namespace chip8cpp
         if (!m_IsValid)
         {
             std::cerr << "Chip8 instance is not valid. Please load a valid program first." << std::endl;
+            ++m_StalledCycles;
             return;
         }
 
-        // Fetch the opcode from memory
-        uint16_t opcode = fetchOpcode();
+        // Picks the instantiation for the whole cycle, emulateCycles() picks it once for the whole run
+        if (m_Debugger)
+        {
+            executeCycle<detail::DebuggerHooks>();
+        }
+        else
+        {
+            executeCycle<detail::NoHooks>();
+        }
 
-        // Decode and execute the opcode
-        decodeAndExecuteOpcode(opcode);
+#ifdef DEBUG
+        printKeyStates();
+#endif
+    }
 
-        // Update timers
-        updateTimers();
+    uint32_t Chip8::emulateCycles(uint32_t cycleCount)
+    {
+        m_StalledCycles            = 0;
+        const uint32_t totalCycles = cycleCount;
 
-#ifdef DEBUG
-        // Debug graphics buffer using CLI ASCII art
-        if (m_Config.printAsciiGraphics)
+        // Without native code or a debugger no callback runs that could attach one, so the cycles skip the checks
+        if (!m_CompiledProgram && !m_Debugger && m_IsValid)
         {
-            std::cout << "\033[2J\033[1;1H";
-            std::cout << "Graphics buffer state:" << std::endl;
-            for (size_t y = 0; y < constants::Height; ++y)
+            for (; cycleCount > 0; --cycleCount)
             {
-                for (size_t x = 0; x < constants::Width; ++x)
-                {
-                    size_t index = x + y * constants::Width;
-                    std::cout << (m_GFX[index] ? '#' : '.'); // Print filled block for pixel on, space for pixel off
-                }
-                std::cout << std::endl; // New line after each row
+                executeCycle<detail::NoHooks>();
+#ifdef DEBUG
+                printKeyStates();
+#endif
             }
+            return totalCycles - m_StalledCycles;
         }
 
-        // Debug input key states
-        if (m_Config.printKeyStates)
+        while (cycleCount > 0)
         {
-            for (size_t i = 0; i < constants::KeyCount; ++i)
+            // Native code only runs without a debugger and while memory still holds the bytes it was compiled from
+            if (m_CompiledProgram && !m_Debugger && m_IsValid && m_PC < constants::MemorySize)
             {
-                const auto keyCode = static_cast<KeyCode>(i);
-                if (isKeyPressed(keyCode))
+                const uint16_t blockIndex = m_CompiledProgram->blockIndex[m_PC];
+                if (blockIndex != 0)
                 {
-                    std::cout << std::format("Key {0} is pressed", getKeyCodeName(keyCode)) << std::endl;
+                    const CompiledBlock& block          = m_CompiledProgram->blocks[blockIndex - 1];
+                    const uint64_t       uncheckedLines = m_DirtyLines & ~m_CheckedLines & block.lineMask;
+                    if (uncheckedLines != 0)
+                    {
+                        checkCompiledLines(uncheckedLines);
+                    }
+                    if ((m_ModifiedCodeLines & block.lineMask) == 0)
+                    {
+                        cycleCount -= block.run(*this, (m_PC - block.startAddress) / 2, cycleCount);
+                        continue;
+                    }
                 }
             }
+
+            emulateOneCycle();
+            --cycleCount;
         }
-#endif
+        return totalCycles - m_StalledCycles;
     }
 
-    bool Chip8::isKeyPressed(KeyCode keyCode) const { return m_Keys[static_cast<size_t>(keyCode)] != 0; }
-
-    void Chip8::setKeyState(KeyCode keyCode, bool isPressed)
+    void Chip8::restart()
     {
-        m_Keys[static_cast<size_t>(keyCode)] = isPressed ? 1 : 0;
-    }
+        assert(m_Image);
 
-    bool Chip8::getDrawFlag() const { return m_DrawFlag; }
+        // Back to the state right after loadProgram(), only undoing what the run touched
+        m_PC         = constants::ProgramStartAddress;
+        m_SP         = 0;
+        m_I          = 0;
+        m_DelayTimer = 0;
+        m_SoundTimer = 0;
+        m_DrawFlag   = false;
 
-    const uint8_t* Chip8::getGFX() const { return m_GFX; }
+        std::fill(std::begin(m_V), std::end(m_V), 0);
+        std::fill(std::begin(m_Keys), std::end(m_Keys), 0);
+        std::fill(std::begin(m_Stack), std::end(m_Stack), 0);
 
-    void Chip8::reset()
-    {
-        m_PC         = constants::ProgramStartAddress; // Program counter starts at 0x200
-        m_SP         = 0;                              // Stack pointer
-        m_I          = 0;                              // Index register
-        m_DelayTimer = 0;                              // Delay timer
-        m_SoundTimer = 0;                              // Sound timer
-        m_DrawFlag   = false;                          // Reset draw flag
+        for (uint32_t rows = m_DirtyRows; rows != 0; rows &= rows - 1)
+        {
+            m_GFX[std::countr_zero(rows)] = 0;
+        }
 
-        std::fill(std::begin(m_V), std::end(m_V), 0);           // Clear registers
-        std::fill(std::begin(m_Keys), std::end(m_Keys), 0);     // Clear key states
-        std::fill(std::begin(m_GFX), std::end(m_GFX), 0);       // Clear graphics buffer
-        std::fill(std::begin(m_Memory), std::end(m_Memory), 0); // Clear memory
-        std::fill(std::begin(m_Stack), std::end(m_Stack), 0);   // Clear stack
+        // Copy the dirty lines back from the program image
+        for (uint64_t lines = m_DirtyLines; lines != 0; lines &= lines - 1)
+        {
+            const size_t line = std::countr_zero(lines);
+            restoreLine(line, getImageLine(*m_Image, line));
+        }
 
-        m_IsValid = false; // Reset validity
+        m_DirtyLines        = 0;
+        m_DirtyRows         = 0;
+        m_MemoryHash        = 0;
+        m_CheckedLines      = 0;
+        m_ModifiedCodeLines = 0;
+        m_RandomState       = m_RandomSeed;
+        m_Trap              = Trap::eNone;
+        m_IsValid           = true;
+    }
 
-        // Load font set into memory
-        for (size_t i = 0; i < constants::FontSetSize; ++i)
+    void Chip8::saveCheckpoint(Checkpoint& checkpoint) const
+    {
+        assert(m_Image);
+
+        Snapshot& state = checkpoint.m_State;
+        std::ranges::copy(m_V, state.V);
+        state.I          = m_I;
+        state.PC         = m_PC;
+        state.SP         = m_SP;
+        state.delayTimer = m_DelayTimer;
+        state.soundTimer = m_SoundTimer;
+        std::ranges::copy(m_Stack, state.stack);
+        std::ranges::copy(m_Keys, state.keys);
+        std::ranges::copy(m_GFX, state.gfx);
+
+        // Lines that were never written still match the program image, so only the dirty ones are saved
+        for (uint64_t lines = m_DirtyLines; lines != 0; lines &= lines - 1)
         {
-            m_Memory[i] = FontSet[i];
+            const size_t address = std::countr_zero(lines) * constants::LineSize;
+            std::memcpy(&state.memory[address],
+                        m_PageTable[address / constants::PageSize] + address % constants::PageSize,
+                        constants::LineSize);
         }
+
+        checkpoint.m_DrawFlag    = m_DrawFlag;
+        checkpoint.m_IsValid     = m_IsValid;
+        checkpoint.m_Trap        = m_Trap;
+        checkpoint.m_RandomState = m_RandomState;
+        checkpoint.m_DirtyLines  = m_DirtyLines;
+        checkpoint.m_DirtyRows   = m_DirtyRows;
+        checkpoint.m_MemoryHash  = m_MemoryHash;
     }
 
-    uint16_t Chip8::fetchOpcode() { return (m_Memory[m_PC] << 8) | m_Memory[m_PC + 1]; }
+    void Chip8::restoreCheckpoint(const Checkpoint& checkpoint)
+    {
+        assert(m_Image);
+
+        const Snapshot& state = checkpoint.m_State;
+        std::ranges::copy(state.V, m_V);
+        m_I          = state.I;
+        m_PC         = state.PC;
+        m_SP         = state.SP;
+        m_DelayTimer = state.delayTimer;
+        m_SoundTimer = state.soundTimer;
+        std::ranges::copy(state.stack, m_Stack);
+        std::ranges::copy(state.keys, m_Keys);
+        std::ranges::copy(state.gfx, m_GFX);
+
+        // Only lines dirty now or at the checkpoint can differ from it, the rest still match the program image
+        for (uint64_t lines = m_DirtyLines | checkpoint.m_DirtyLines; lines != 0; lines &= lines - 1)
+        {
+            const size_t line = std::countr_zero(lines);
+            if ((checkpoint.m_DirtyLines & (uint64_t {1} << line)) != 0)
+            {
+                restoreLine(line, &state.memory[line * constants::LineSize]);
+            }
+            else
+            {
+                restoreLine(line, getImageLine(*m_Image, line));
+            }
+        }
+
+        m_DrawFlag    = checkpoint.m_DrawFlag;
+        m_IsValid     = checkpoint.m_IsValid;
+        m_Trap        = checkpoint.m_Trap;
+        m_RandomState = checkpoint.m_RandomState;
+        m_DirtyLines  = checkpoint.m_DirtyLines;
+        m_DirtyRows   = checkpoint.m_DirtyRows;
+        m_MemoryHash  = checkpoint.m_MemoryHash;
+
+        // The restored lines are compared with the compiled code again when it next runs
+        m_CheckedLines      = 0;
+        m_ModifiedCodeLines = 0;
+    }
 
-    void Chip8::decodeAndExecuteOpcode(uint16_t opcode)
+    void Checkpoint::pack(std::vector<uint8_t>& bytes) const
     {
-        // Decode the opcode and execute the corresponding instruction
-        // https://en.wikipedia.org/wiki/CHIP-8
-        // https://tobiasvl.github.io/blog/write-a-chip-8-emulator/#instructions
-        // https://chip8.gulrak.net/
-        // TODO: Implement opcodes for Super CHIP-8 and XO-CHIP-8
-        switch (opcode & 0xF000)
+        const auto append = [&bytes](const void* data, size_t size)
         {
-            case 0x0000:
-                switch (opcode & 0x00FF)
-                {
-                    case 0x00E0: // 0x00E0: Clear the display
-                        std::ranges::fill(m_GFX, 0);
-                        m_DrawFlag = true;
-                        m_PC += 2;
-                        break;
-
-                    case 0x00EE: // 0x00EE: Return from subroutine
-                        if (m_SP == 0)
-                        {
-                            std::cerr << "Stack underflow on return from subroutine." << std::endl;
-                            return;
-                        }
-                        m_PC = m_Stack[--m_SP] + 2; // Pop from stack and set PC
-                        break;
-
-                    default:
-                        assert(0); // Unknown opcode
-                }
-                break;
+            const auto* begin = static_cast<const uint8_t*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+        };
+
+        PackedFields fields {};
+        std::ranges::copy(m_State.V, fields.V);
+        fields.I          = m_State.I;
+        fields.PC         = m_State.PC;
+        fields.SP         = m_State.SP;
+        fields.delayTimer = m_State.delayTimer;
+        fields.soundTimer = m_State.soundTimer;
+        fields.drawFlag   = m_DrawFlag;
+        fields.isValid    = m_IsValid;
+        fields.trap       = m_Trap;
+        std::ranges::copy(m_State.stack, fields.stack);
+        std::ranges::copy(m_State.keys, fields.keys);
+        fields.randomState = m_RandomState;
+        fields.dirtyRows   = m_DirtyRows;
+        fields.dirtyLines  = m_DirtyLines;
+        fields.memoryHash  = m_MemoryHash;
+
+        append(&fields, sizeof(fields));
+        for (uint32_t rows = m_DirtyRows; rows != 0; rows &= rows - 1)
+        {
+            append(&m_State.gfx[std::countr_zero(rows)], sizeof(uint64_t));
+        }
+        for (uint64_t lines = m_DirtyLines; lines != 0; lines &= lines - 1)
+        {
+            append(&m_State.memory[std::countr_zero(lines) * constants::LineSize], constants::LineSize);
+        }
+    }
 
-            case 0x1000: // 0x1NNN: Jump to address NNN
-                m_PC = opcode & 0x0FFF;
-                break;
+    bool Checkpoint::unpack(std::span<const uint8_t> bytes)
+    {
+        PackedFields fields {};
+        if (bytes.size() < sizeof(fields))
+        {
+            return false;
+        }
+        std::memcpy(&fields, bytes.data(), sizeof(fields));
 
-            case 0x2000:                           // 0x2NNN: Call subroutine at NNN
-                m_Stack[m_SP++] = m_PC;            // Push current PC onto stack
-                m_PC            = opcode & 0x0FFF; // Set PC to NNN
-                break;
+        const size_t size = sizeof(fields) + std::popcount(fields.dirtyRows) * sizeof(uint64_t) +
+                            std::popcount(fields.dirtyLines) * constants::LineSize;
+        if (bytes.size() != size)
+        {
+            return false; // Not a packed checkpoint
+        }
 
-            case 0x3000: // 0x3XNN: Skip next instruction if VX == NN
-                if (m_V[(opcode & 0x0F00) >> 8] == (opcode & 0x00FF))
-                {
-                    m_PC += 4; // Skip next instruction
-                }
-                else
-                {
-                    m_PC += 2; // Move to next instruction
-                }
-                break;
+        std::ranges::copy(fields.V, m_State.V);
+        m_State.I          = fields.I;
+        m_State.PC         = fields.PC;
+        m_State.SP         = fields.SP;
+        m_State.delayTimer = fields.delayTimer;
+        m_State.soundTimer = fields.soundTimer;
+        m_DrawFlag         = fields.drawFlag;
+        m_IsValid          = fields.isValid;
+        m_Trap             = fields.trap;
+        std::ranges::copy(fields.stack, m_State.stack);
+        std::ranges::copy(fields.keys, m_State.keys);
+        m_RandomState = fields.randomState;
+        m_DirtyRows   = fields.dirtyRows;
+        m_DirtyLines  = fields.dirtyLines;
+        m_MemoryHash  = fields.memoryHash;
+
+        // Rows that were never drawn to are blank, memory lines that were never written aren't restored from it
+        const uint8_t* data = bytes.data() + sizeof(fields);
+        std::ranges::fill(m_State.gfx, 0);
+        for (uint32_t rows = m_DirtyRows; rows != 0; rows &= rows - 1)
+        {
+            std::memcpy(&m_State.gfx[std::countr_zero(rows)], data, sizeof(uint64_t));
+            data += sizeof(uint64_t);
+        }
+        for (uint64_t lines = m_DirtyLines; lines != 0; lines &= lines - 1)
+        {
+            std::memcpy(&m_State.memory[std::countr_zero(lines) * constants::LineSize], data, constants::LineSize);
+            data += constants::LineSize;
+        }
+        return true;
+    }
 
-            case 0x4000: // 0x4XNN: Skip next instruction if VX != NN
-                if (m_V[(opcode & 0x0F00) >> 8] != (opcode & 0x00FF))
-                {
-                    m_PC += 4; // Skip next instruction
-                }
-                else
-                {
-                    m_PC += 2; // Move to next instruction
-                }
-                break;
+    void Chip8::setRandomSeed(uint32_t seed)
+    {
+        // Scramble the seed first, xorshift starts out with small numbers for small seeds and nearby seeds give
+        // similar first numbers, e.g. for consecutive seeds of a batch of environments
+        seed ^= seed >> 16;
+        seed *= 0x85EBCA6B;
+        seed ^= seed >> 13;
+        seed *= 0xC2B2AE35;
+        seed ^= seed >> 16;
+        m_RandomSeed  = seed != 0 ? seed : 1; // Xorshift gets stuck at 0
+        m_RandomState = m_RandomSeed;
+    }
 
-            case 0x5000: // 0x5XY0: Skip next instruction if VX == VY
-                if (m_V[(opcode & 0x0F00) >> 8] == m_V[(opcode & 0x00F0) >> 4])
-                {
-                    m_PC += 4; // Skip next instruction
-                }
-                else
-                {
-                    m_PC += 2; // Move to next instruction
-                }
-                break;
+    bool Chip8::isKeyPressed(KeyCode keyCode) const { return m_Keys[static_cast<size_t>(keyCode)] != 0; }
 
-            case 0x6000: // 0x6XNN: Set register VX to NN
-                m_V[(opcode & 0x0F00) >> 8] = opcode & 0x00FF;
-                m_PC += 2;
-                break;
+    void Chip8::setKeyState(KeyCode keyCode, bool isPressed)
+    {
+        m_Keys[static_cast<size_t>(keyCode)] = isPressed ? 1 : 0;
+    }
 
-            case 0x7000: // 0x7XNN: Add NN to register VX
-                m_V[(opcode & 0x0F00) >> 8] += opcode & 0x00FF;
-                m_PC += 2;
-                break;
+    bool Chip8::getDrawFlag() const { return m_DrawFlag; }
+    Trap Chip8::getTrap() const { return m_Trap; }
 
-            case 0x8000: // 0x8XY0: Set VX to VY
-                switch (opcode & 0x000F)
-                {
-                    case 0x0000: // 0x8XY0: Set VX to VY
-                        m_V[(opcode & 0x0F00) >> 8] = m_V[(opcode & 0x00F0) >> 4];
-                        break;
+    uint64_t Chip8::getStateHash() const
+    {
+        // Everything that decides how the program continues, the keys are its input and left out.
+        // Stack entries above SP are never read again before being overwritten.
+        uint64_t registers[constants::RegisterCount / sizeof(uint64_t)];
+        std::memcpy(registers, m_V, sizeof(registers));
 
-                    case 0x0001: // 0x8XY1: Set VX to VX OR VY
-                        m_V[(opcode & 0x0F00) >> 8] |= m_V[(opcode & 0x00F0) >> 4];
-                        break;
+        uint64_t hash = 0;
+        for (const uint64_t registerBytes : registers)
+        {
+            hash = mixHash(hash ^ registerBytes);
+        }
+        hash = mixHash(hash ^ (uint64_t {m_I} | uint64_t {m_PC} << 16 | uint64_t {m_SP} << 32 |
+                               uint64_t {m_DelayTimer} << 40 | uint64_t {m_SoundTimer} << 48 |
+                               uint64_t {static_cast<uint8_t>(m_Trap)} << 56));
+        hash = mixHash(hash ^ m_RandomState);
+        for (size_t i = 0; i < m_SP; ++i)
+        {
+            hash = mixHash(hash ^ m_Stack[i]);
+        }
 
-                    case 0x0002: // 0x8XY2: Set VX to VX AND VY
-                        m_V[(opcode & 0x0F00) >> 8] &= m_V[(opcode & 0x00F0) >> 4];
-                        break;
+        // Memory is hashed as it is written, only the rows drawn to are hashed here
+        hash ^= m_MemoryHash;
+        for (uint32_t rows = m_DirtyRows; rows != 0; rows &= rows - 1)
+        {
+            const size_t row = std::countr_zero(rows);
+            if (m_GFX[row] != 0)
+            {
+                hash ^= mixHash(m_GFX[row] ^ mixHash(row + 1));
+            }
+        }
+        return hash;
+    }
 
-                    case 0x0003: // 0x8XY3: Set VX to VX XOR VY
-                        m_V[(opcode & 0x0F00) >> 8] ^= m_V[(opcode & 0x00F0) >> 4];
-                        break;
+    const uint64_t* Chip8::getGFX() const { return m_GFX; }
 
-                    case 0x0004: // 0x8XY4: Add VY to VX, set VF if carry
-                    {
-                        uint16_t sum                = m_V[(opcode & 0x0F00) >> 8] + m_V[(opcode & 0x00F0) >> 4];
-                        m_V[0xF]                    = (sum > 255) ? 1 : 0; // Set carry flag
-                        m_V[(opcode & 0x0F00) >> 8] = sum & 0xFF;          // Store result in VX
-                        break;
-                    }
+    bool Chip8::getPixel(size_t x, size_t y) const { return (m_GFX[y] & (PixelMask >> x)) != 0; }
 
-                    case 0x0005: // 0x8XY5: Subtract VY from VX, set VF if no borrow
-                    {
-                        m_V[0xF] = (m_V[(opcode & 0x00F0) >> 4] <= m_V[(opcode & 0x0F00) >> 8]) ? 1 : 0;
-                        m_V[(opcode & 0x0F00) >> 8] -= m_V[(opcode & 0x00F0) >> 4];
-                        break;
-                    }
+    uint8_t Chip8::readMemory(uint16_t address) const
+    {
+        address &= constants::MemorySize - 1; // Wrap around instead of reading out of bounds
+        return m_PageTable[address / constants::PageSize][address % constants::PageSize];
+    }
 
-                    case 0x0006: // 0x8XY6: Shift VX right by 1, set VF to LSB
-                    {
-                        m_V[0xF] = m_V[(opcode & 0x0F00) >> 8] & 0x01; // Store LSB in VF
-                        m_V[(opcode & 0x0F00) >> 8] >>= 1;             // Shift right
-                        break;
-                    }
+    uint16_t Chip8::getPC() const { return m_PC; }
 
-                    case 0x0007: // 0x8XY7: Set VX to VY - VX, set VF if no borrow
-                    {
-                        m_V[0xF] = (m_V[(opcode & 0x0F00) >> 8] <= m_V[(opcode & 0x00F0) >> 4]) ? 1 : 0;
-                        m_V[(opcode & 0x0F00) >> 8] = m_V[(opcode & 0x00F0) >> 4] - m_V[(opcode & 0x0F00) >> 8];
-                        break;
-                    }
+    void Chip8::captureSnapshot(Snapshot& snapshot) const
+    {
+        std::ranges::copy(m_V, snapshot.V);
+        snapshot.I          = m_I;
+        snapshot.PC         = m_PC;
+        snapshot.SP         = m_SP;
+        snapshot.delayTimer = m_DelayTimer;
+        snapshot.soundTimer = m_SoundTimer;
+        std::ranges::copy(m_Stack, snapshot.stack);
+        std::ranges::copy(m_Keys, snapshot.keys);
+        std::ranges::copy(m_GFX, snapshot.gfx);
+
+        if (!m_Image)
+        {
+            std::ranges::fill(snapshot.memory, 0); // No program loaded
+            return;
+        }
+        for (size_t i = 0; i < constants::PageCount; ++i)
+        {
+            std::memcpy(&snapshot.memory[i * constants::PageSize], m_PageTable[i], constants::PageSize);
+        }
+    }
 
-                    case 0x000E: // 0x8XYE: Shift VX left by 1, set VF to MSB
-                    {
-                        m_V[0xF] = (m_V[(opcode & 0x0F00) >> 8] & 0x80) >> 7; // Store MSB in VF
-                        m_V[(opcode & 0x0F00) >> 8] <<= 1;                    // Shift left
-                        break;
-                    }
+    size_t Chip8::getPrivatePageCount() const
+    {
+        return std::ranges::count_if(m_PrivatePages, [](const auto& page) { return page != nullptr; });
+    }
 
-                    default:
-                        assert(0); // Unknown opcode
-                }
-                m_PC += 2;
-                break;
+    void Chip8::reset()
+    {
+        m_PC         = constants::ProgramStartAddress; // Program counter starts at 0x200
+        m_SP         = 0;                              // Stack pointer
+        m_I          = 0;                              // Index register
+        m_DelayTimer = 0;                              // Delay timer
+        m_SoundTimer = 0;                              // Sound timer
+        m_DrawFlag   = false;                          // Reset draw flag
 
-            case 0x9000: // 0x9XY0: Skip next instruction if VX != VY
-                if (m_V[(opcode & 0x0F00) >> 8] != m_V[(opcode & 0x00F0) >> 4])
-                {
-                    m_PC += 4; // Skip next instruction
-                }
-                else
-                {
-                    m_PC += 2; // Move to next instruction
-                }
-                break;
+        std::fill(std::begin(m_V), std::end(m_V), 0);         // Clear registers
+        std::fill(std::begin(m_Keys), std::end(m_Keys), 0);   // Clear key states
+        std::fill(std::begin(m_GFX), std::end(m_GFX), 0);     // Clear graphics buffer
+        std::fill(std::begin(m_Stack), std::end(m_Stack), 0); // Clear stack
 
-            case 0xA000: // 0xANNN: Set index register I to NNN
-                m_I = opcode & 0x0FFF;
-                m_PC += 2;
-                break;
+        m_DirtyLines = 0;
+        m_DirtyRows  = 0;
+        m_MemoryHash = 0;
+        m_Trap       = Trap::eNone;
 
-            case 0xB000: // 0xBNNN: Jump to address NNN + V0
-                m_PC = (opcode & 0x0FFF) + m_V[0];
-                break;
+        m_CompiledProgram   = nullptr;
+        m_CheckedLines      = 0;
+        m_ModifiedCodeLines = 0;
 
-            case 0xC000: // 0xCXNN: Set VX to random byte AND NN
-            {
-                std::random_device                 rd;
-                std::mt19937                       gen(rd());
-                std::uniform_int_distribution<int> dist(0, 255);
-                uint8_t                            randomByte = static_cast<uint8_t>(dist(gen));
-                m_V[(opcode & 0x0F00) >> 8]                   = randomByte & (opcode & 0x00FF);
-                m_PC += 2;
-                break;
-            }
+        // Drop the program image and every private page
+        m_Image.reset();
+        std::fill(std::begin(m_PageTable), std::end(m_PageTable), nullptr);
+        std::fill(std::begin(m_PrivatePages), std::end(m_PrivatePages), nullptr);
 
-            case 0xD000: // 0xDXYN: Draw sprite at (VX, VY) with height N
-            {
-                uint8_t x      = m_V[(opcode & 0x0F00) >> 8];
-                uint8_t y      = m_V[(opcode & 0x00F0) >> 4];
-                uint8_t height = opcode & 0x000F;
-                m_V[0xF]       = 0; // Clear collision flag
+        m_IsValid = false; // Reset validity
+    }
 
-                for (uint8_t row = 0; row < height; ++row)
-                {
-                    uint8_t pixel = m_Memory[m_I + row];
-                    for (uint8_t col = 0; col < 8; ++col)
-                    {
-                        if ((pixel & (0x80 >> col)) != 0)
-                        {
-                            size_t gfxIndex = (x + col + (y + row) * constants::Width) % constants::GfxSize;
-                            if (m_GFX[gfxIndex] == 1)
-                                m_V[0xF] = 1;     // Collision detected
-                            m_GFX[gfxIndex] ^= 1; // Toggle pixel
-                        }
-                    }
-                }
-                m_DrawFlag = true;
-                m_PC += 2;
-                break;
-            }
+    void Chip8::attachDebugger(Debugger* debugger) { m_Debugger = debugger; }
 
-            case 0xE000: // 0xEXNN: Key operations
+    template <typename Hooks>
+    void Chip8::executeCycle()
+    {
+        if constexpr (Hooks::IsDebugging)
+        {
+            if (!m_Debugger->checkBreakpoint(m_PC))
             {
-                switch (opcode & 0x00FF)
-                {
-                    case 0x009E: // 0xEX9E: Skip next instruction if key VX is pressed
-                        if (isKeyPressed(static_cast<KeyCode>(m_V[(opcode & 0x0F00) >> 8])))
-                        {
-                            m_PC += 4; // Skip next instruction
-                        }
-                        else
-                        {
-                            m_PC += 2; // Move to next instruction
-                        }
-                        break;
-
-                    case 0x00A1: // 0xEXA1: Skip next instruction if key VX is not pressed
-                        if (!isKeyPressed(static_cast<KeyCode>(m_V[(opcode & 0x0F00) >> 8])))
-                        {
-                            m_PC += 4; // Skip next instruction
-                        }
-                        else
-                        {
-                            m_PC += 2; // Move to next instruction
-                        }
-                        break;
-                    default:
-                        assert(0); // Unknown opcode
-                }
-                break;
+                ++m_StalledCycles;
+                return; // Halted by the debugger
             }
+        }
 
-            case 0xF000: // 0xFXNN: Miscellaneous operations
-            {
-                switch (opcode & 0x00FF)
-                {
-                    case 0x0007: // 0xFX07: Set VX to delay timer value
-                        m_V[(opcode & 0x0F00) >> 8] = m_DelayTimer;
-                        m_PC += 2;
-                        break;
-
-                    case 0x000A: // 0xFX0A: Wait for key press, store in VX
-                    {
-                        bool keyPressed = false;
-                        for (size_t i = 0; i < constants::KeyCount; ++i)
-                        {
-                            if (isKeyPressed(static_cast<KeyCode>(i)))
-                            {
-                                m_V[(opcode & 0x0F00) >> 8] = static_cast<uint8_t>(i);
-                                keyPressed                  = true;
-                                break;
-                            }
-                        }
-                        if (!keyPressed)
-                        {
-                            return; // Wait for key press
-                        }
-                        m_PC += 2;
-                        break;
-                    }
-
-                    case 0x0015: // 0xFX15: Set delay timer to VX
-                        m_DelayTimer = m_V[(opcode & 0x0F00) >> 8];
-                        m_PC += 2;
-                        break;
-
-                    case 0x0018: // 0xFX18: Set sound timer to VX
-                        m_SoundTimer = m_V[(opcode & 0x0F00) >> 8];
-                        m_PC += 2;
-                        break;
-
-                    case 0x001E: // 0xFX1E: Add VX to I
-                        m_I += m_V[(opcode & 0x0F00) >> 8];
-                        m_PC += 2;
-                        break;
-
-                    case 0x0029: // 0xFX29: Set I to the location of the sprite for digit VX
-                    {
-                        uint8_t digit = m_V[(opcode & 0x0F00) >> 8];
-                        if (digit < constants::FontSetSize / constants::FontHeight)
-                            m_I = digit * constants::FontHeight; // Each font character is stored in memory sequentially
-                        else
-                            std::cerr << "Invalid digit for sprite location." << std::endl;
-                        m_PC += 2;
-                        break;
-                    }
-
-                    case 0x0033: // 0xFX33: Store BCD representation of VX in memory at I
-                    {
-                        uint8_t value     = m_V[(opcode & 0x0F00) >> 8];
-                        m_Memory[m_I]     = value / 100;       // Hundreds digit
-                        m_Memory[m_I + 1] = (value / 10) % 10; // Tens digit
-                        m_Memory[m_I + 2] = value % 10;        // Ones digit
-                        m_PC += 2;
-                        break;
-                    }
+        // Fetch the opcode from memory
+        uint16_t opcode = fetchOpcode();
 
-                    case 0x0055: // 0xFX55: Store registers V0 to VX in memory starting at I
-                    {
-                        uint8_t x = (opcode & 0x0F00) >> 8;
-                        for (uint8_t i = 0; i <= x; ++i)
-                        {
-                            m_Memory[m_I + i] = m_V[i];
-                        }
-                        m_I += x + 1; // Move I forward by the number of registers stored
-                        m_PC += 2;
-                        break;
-                    }
+        // Decode and execute the opcode
+        decodeAndExecuteOpcode<Hooks>(opcode);
 
-                    case 0x0065: // 0xFX65: Read registers V0 to VX from memory starting at I
-                    {
-                        uint8_t x = (opcode & 0x0F00) >> 8;
-                        for (uint8_t i = 0; i <= x; ++i)
-                        {
-                            m_V[i] = m_Memory[m_I + i];
-                        }
-                        m_I += x + 1; // Move I forward by the number of registers read
-                        m_PC += 2;
-                        break;
-                    }
+        // Update timers
+        updateTimers();
+    }
 
-                    default:
-                        assert(0); // Unknown opcode
+#ifdef DEBUG
+    void Chip8::printKeyStates() const
+    {
+        // Debug input key states
+        if (m_Config->printKeyStates)
+        {
+            for (size_t i = 0; i < constants::KeyCount; ++i)
+            {
+                const auto keyCode = static_cast<KeyCode>(i);
+                if (isKeyPressed(keyCode))
+                {
+                    std::cout << std::format("Key {0} is pressed", getKeyCodeName(keyCode)) << std::endl;
                 }
-                break;
             }
-
-            default:
-                std::cout << std::format("Unknown opcode: 0x{:02X} at PC: 0x{:04X}", opcode, m_PC) << std::endl;
         }
     }
+#endif
+
+    uint16_t Chip8::fetchOpcode() { return (readMemory(m_PC) << 8) | readMemory(m_PC + 1); }
+
+    template <typename Hooks>
+    void Chip8::decodeAndExecuteOpcode(uint16_t opcode)
+    {
+        detail::HandlerTable<Hooks>[getDispatchIndex()[opcode]](*this, opcode);
+    }
 
     void Chip8::updateTimers()
     {
@@ -558,21 +695,98 @@ namespace chip8cpp
                 std::cout << "BEEP! Sound timer reached zero." << std::endl;
 #endif
                 // Callback to play sound
-                if (m_Config.soundCallback)
+                if (m_Config->soundCallback)
                 {
-                    m_Config.soundCallback();
+                    m_Config->soundCallback();
                 }
             }
             --m_SoundTimer;
         }
     }
 
-    void Chip8::loadFontSet()
+    void Chip8::raiseTrap(Trap trap, uint16_t opcode)
+    {
+        // Trapped instructions don't advance the PC and run again every cycle, only report the first time
+        ++m_StalledCycles;
+        if (m_Trap == Trap::eNone)
+        {
+            m_Trap = trap;
+            if (m_Config->printTraps)
+            {
+                std::cerr << std::format("{} 0x{:04X} at PC: 0x{:03X}", getTrapName(trap), opcode, m_PC) << std::endl;
+            }
+        }
+    }
+
+    void Chip8::checkCompiledLines(uint64_t lines)
+    {
+        // Programs often keep data next to their code, so a written line doesn't mean its code changed.
+        // Only the bytes of compiled instructions are compared, the result holds until the line is written again.
+        const std::span<const uint8_t>  program    = m_CompiledProgram->program;
+        const std::span<const uint16_t> blockIndex = m_CompiledProgram->blockIndex;
+        for (; lines != 0; lines &= lines - 1)
+        {
+            const size_t   line       = std::countr_zero(lines);
+            const uint64_t lineBit    = uint64_t {1} << line;
+            bool           isModified = false;
+            for (size_t address = line * constants::LineSize; address < (line + 1) * constants::LineSize; ++address)
+            {
+                const bool isCode = blockIndex[address] != 0 || (address > 0 && blockIndex[address - 1] != 0);
+                if (isCode && readMemory(static_cast<uint16_t>(address)) !=
+                                  program[address - constants::ProgramStartAddress])
+                {
+                    isModified = true;
+                    break;
+                }
+            }
+
+            m_CheckedLines |= lineBit;
+            m_ModifiedCodeLines = isModified ? m_ModifiedCodeLines | lineBit : m_ModifiedCodeLines & ~lineBit;
+        }
+    }
+
+    void Chip8::writeMemory(uint16_t address, uint8_t value)
+    {
+        address &= constants::MemorySize - 1; // Wrap around instead of writing out of bounds
+
+        // Copy the page on first write, or when it is still shared with a copied instance
+        const size_t pageIndex = address / constants::PageSize;
+        if (!m_PrivatePages[pageIndex] || m_PrivatePages[pageIndex].use_count() != 1)
+        {
+            makePagePrivate(pageIndex);
+        }
+        uint8_t& byte = m_PrivatePages[pageIndex]->bytes[address % constants::PageSize];
+        m_MemoryHash ^= hashMemoryByte(address, byte) ^ hashMemoryByte(address, value);
+        byte = value;
+        m_DirtyLines |= uint64_t {1} << (address / constants::LineSize);
+        m_CheckedLines &= ~(uint64_t {1} << (address / constants::LineSize));
+    }
+
+    void Chip8::restoreLine(size_t line, const uint8_t* source)
     {
-        // Load the Chip-8 font set into memory
-        for (size_t i = 0; i < constants::FontSetSize; ++i)
+        const size_t address   = line * constants::LineSize;
+        const size_t pageIndex = address / constants::PageSize;
+        if (!m_PrivatePages[pageIndex] || m_PrivatePages[pageIndex].use_count() != 1)
         {
-            m_Memory[i] = FontSet[i];
+            makePagePrivate(pageIndex);
         }
+        std::memcpy(&m_PrivatePages[pageIndex]->bytes[address % constants::PageSize], source, constants::LineSize);
+    }
+
+    void Chip8::makePagePrivate(size_t pageIndex)
+    {
+        auto page = std::make_shared<MemoryPage>();
+        std::memcpy(page->bytes, m_PageTable[pageIndex], constants::PageSize);
+        m_PageTable[pageIndex]    = page->bytes;
+        m_PrivatePages[pageIndex] = std::move(page);
+    }
+
+    uint8_t Chip8::nextRandomByte()
+    {
+        // Xorshift32, cheap and part of the saved state, so replaying from a checkpoint gives the same numbers
+        m_RandomState ^= m_RandomState << 13;
+        m_RandomState ^= m_RandomState >> 17;
+        m_RandomState ^= m_RandomState << 5;
+        return static_cast<uint8_t>(m_RandomState >> 24);
     }
-} // namespace chip8cpp
+} // namespace chip8cpp
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "chip8cpp/chip8cpp.hpp"
+
+#include <algorithm>
+
+namespace chip8cpp
+{
+    void Debugger::setBreakpoint(uint16_t address, bool isEnabled)
+    {
+        address &= constants::MemorySize - 1;
+        setBits(m_Breakpoints, address, address + 1, isEnabled);
+    }
+
+    void Debugger::setReadWatch(uint16_t begin, uint16_t end, bool isEnabled)
+    {
+        setBits(m_ReadWatches, begin, end, isEnabled);
+    }
+
+    void Debugger::setWriteWatch(uint16_t begin, uint16_t end, bool isEnabled)
+    {
+        setBits(m_WriteWatches, begin, end, isEnabled);
+    }
+
+    void Debugger::clear()
+    {
+        std::ranges::fill(m_Breakpoints, 0);
+        std::ranges::fill(m_ReadWatches, 0);
+        std::ranges::fill(m_WriteWatches, 0);
+    }
+
+    bool Debugger::hasBreakpoint(uint16_t address) const { return testBit(m_Breakpoints, address); }
+    bool Debugger::isReadWatched(uint16_t address) const { return testBit(m_ReadWatches, address); }
+    bool Debugger::isWriteWatched(uint16_t address) const { return testBit(m_WriteWatches, address); }
+
+    void Debugger::setEventCallback(std::function<void(const DebugEvent&)> eventCallback)
+    {
+        m_EventCallback = std::move(eventCallback);
+    }
+
+    bool              Debugger::isHalted() const { return m_IsHalted; }
+    const DebugEvent& Debugger::getLastEvent() const { return m_LastEvent; }
+
+    void Debugger::resume()
+    {
+        // Without skipping it once, the breakpoint would halt again before its instruction ever runs
+        m_SkipBreakpoint = m_IsHalted && m_LastEvent.type == DebugEventType::eBreakpoint;
+        m_IsHalted       = false;
+    }
+
+    bool Debugger::checkBreakpoint(uint16_t pc)
+    {
+        if (m_IsHalted)
+        {
+            return false;
+        }
+
+        if (m_SkipBreakpoint)
+        {
+            m_SkipBreakpoint = false;
+            return true;
+        }
+
+        if (testBit(m_Breakpoints, pc))
+        {
+            halt({DebugEventType::eBreakpoint, pc, pc});
+            return false;
+        }
+        return true;
+    }
+
+    void Debugger::checkRead(uint16_t address, uint16_t pc)
+    {
+        if (testBit(m_ReadWatches, address))
+        {
+            halt({DebugEventType::eReadWatch, pc, address});
+        }
+    }
+
+    void Debugger::checkWrite(uint16_t address, uint16_t pc)
+    {
+        if (testBit(m_WriteWatches, address))
+        {
+            halt({DebugEventType::eWriteWatch, pc, address});
+        }
+    }
+
+    void Debugger::halt(const DebugEvent& event)
+    {
+        m_IsHalted  = true;
+        m_LastEvent = event;
+        if (m_EventCallback)
+        {
+            m_EventCallback(event);
+        }
+    }
+
+    bool Debugger::testBit(const AddressBitmap& bitmap, uint16_t address)
+    {
+        address &= constants::MemorySize - 1; // Same wrap around as the memory accesses
+        return (bitmap[address / 64] >> (address % 64) & 1) != 0;
+    }
+
+    void Debugger::setBits(AddressBitmap& bitmap, uint16_t begin, uint16_t end, bool isEnabled)
+    {
+        // Ranges past the end of memory are cut off there, an empty or reversed range changes nothing
+        end = static_cast<uint16_t>(std::min<size_t>(end, constants::MemorySize));
+        for (uint16_t address = begin; address < end; ++address)
+        {
+            const uint64_t bit = uint64_t {1} << (address % 64);
+            if (isEnabled)
+            {
+                bitmap[address / 64] |= bit;
+            }
+            else
+            {
+                bitmap[address / 64] &= ~bit;
+            }
+        }
+    }
+} // namespace chip8cpp
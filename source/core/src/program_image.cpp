@@ -0,0 +1,154 @@
+#include "chip8cpp/chip8cpp.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    constexpr uint8_t FontSet[chip8cpp::constants::FontSetSize] = {
+        // Fontset data (0x0 to 0xF)
+        0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
+        0x20, 0x60, 0x20, 0x20, 0x70, // 1
+        0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
+        0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
+        0x90, 0x90, 0xF0, 0x10, 0x10, // 4
+        0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
+        0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
+        0xF0, 0x10, 0x20, 0x40, 0x40, // 7
+        0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
+        0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
+        0xF0, 0x90, 0xF0, 0x90, 0x90, // A
+        0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
+        0xF0, 0x80, 0x80, 0x80, 0xF0, // C
+        0xE0, 0x90, 0x90, 0x90, 0xE0, // D
+        0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
+        0xF0, 0x80, 0xF0, 0x80, 0x80  // F
+    };
+
+    static_assert(chip8cpp::constants::ProgramStartAddress % chip8cpp::constants::PageSize == 0);
+
+    constexpr size_t ProgramStartPage = chip8cpp::constants::ProgramStartAddress / chip8cpp::constants::PageSize;
+    constexpr size_t MaxProgramSize   = chip8cpp::constants::MemorySize - chip8cpp::constants::ProgramStartAddress;
+
+    // Memory below the program start, with the font set loaded at 0x000, shared by every image
+    alignas(64) constexpr auto SystemArea = [] {
+        std::array<uint8_t, chip8cpp::constants::ProgramStartAddress> systemArea {};
+        for (size_t i = 0; i < chip8cpp::constants::FontSetSize; ++i)
+        {
+            systemArea[i] = FontSet[i];
+        }
+        return systemArea;
+    }();
+
+    // Page for memory past the end of the program, shared by every image
+    alignas(64) constexpr uint8_t ZeroPage[chip8cpp::constants::PageSize] {};
+
+    // Bytes needed to hold a program in whole pages
+    size_t getPagedSize(size_t programSize)
+    {
+        return (programSize + chip8cpp::constants::PageSize - 1) / chip8cpp::constants::PageSize *
+               chip8cpp::constants::PageSize;
+    }
+} // namespace
+
+namespace chip8cpp
+{
+    ProgramImage::ProgramImage()
+    {
+        for (size_t i = 0; i < constants::PageCount; ++i)
+        {
+            m_Pages[i] = i < ProgramStartPage ? &SystemArea[i * constants::PageSize] : ZeroPage;
+        }
+    }
+
+    std::shared_ptr<const ProgramImage> ProgramImage::loadFromFile(const std::string& fileName)
+    {
+        // Load the program into memory starting at 0x200
+        // Read file using C++ file I/O
+        std::ifstream file(fileName, std::ios::binary);
+        if (!file.is_open())
+        {
+            return nullptr; // Failed to open the file
+        }
+        file.seekg(0, std::ios::end);
+        size_t fileSize = file.tellg();
+        file.seekg(0, std::ios::beg);
+        if (fileSize > MaxProgramSize) // 4096 bytes total, 512 bytes reserved for system
+        {
+            return nullptr; // Program too large to fit in memory
+        }
+
+        // Read straight into the pages owned by the image
+        std::shared_ptr<ProgramImage> image(new ProgramImage());
+        image->m_OwnedBytes = std::make_unique<uint8_t[]>(getPagedSize(fileSize));
+        file.read(reinterpret_cast<char*>(image->m_OwnedBytes.get()), fileSize);
+        if (!file)
+        {
+            return nullptr; // Failed to read the file
+        }
+        image->mapProgram(image->m_OwnedBytes.get(), fileSize);
+
+        return image;
+    }
+
+    std::shared_ptr<const ProgramImage> ProgramImage::create(std::span<const uint8_t> program)
+    {
+        if (program.size() > MaxProgramSize)
+        {
+            return nullptr; // Program too large to fit in memory
+        }
+
+        std::shared_ptr<ProgramImage> image(new ProgramImage());
+        image->m_OwnedBytes = std::make_unique<uint8_t[]>(getPagedSize(program.size()));
+        std::memcpy(image->m_OwnedBytes.get(), program.data(), program.size());
+        image->mapProgram(image->m_OwnedBytes.get(), program.size());
+
+        return image;
+    }
+
+    std::shared_ptr<const ProgramImage> ProgramImage::createView(std::span<const uint8_t> program)
+    {
+        if (program.size() > MaxProgramSize)
+        {
+            return nullptr; // Program too large to fit in memory
+        }
+
+        std::shared_ptr<ProgramImage> image(new ProgramImage());
+
+        // Only a partial last page is copied, it can't be read in place without running past the program
+        const size_t tailSize = program.size() % constants::PageSize;
+        if (tailSize != 0)
+        {
+            image->m_OwnedBytes = std::make_unique<uint8_t[]>(constants::PageSize);
+            std::memcpy(image->m_OwnedBytes.get(), &program[program.size() - tailSize], tailSize);
+        }
+        image->mapProgram(program.data(), program.size() - tailSize);
+        if (tailSize != 0)
+        {
+            image->m_Pages[ProgramStartPage + program.size() / constants::PageSize] = image->m_OwnedBytes.get();
+        }
+        image->m_ProgramSize = program.size();
+
+        return image;
+    }
+
+    const uint8_t* ProgramImage::getPage(size_t pageIndex) const
+    {
+        assert(pageIndex < constants::PageCount);
+        return m_Pages[pageIndex];
+    }
+
+    size_t ProgramImage::getProgramSize() const { return m_ProgramSize; }
+
+    void ProgramImage::mapProgram(const uint8_t* program, size_t programSize)
+    {
+        // Partial pages are only passed in when the bytes behind the program are readable and zeroed
+        for (size_t offset = 0; offset < programSize; offset += constants::PageSize)
+        {
+            m_Pages[ProgramStartPage + offset / constants::PageSize] = program + offset;
+        }
+        m_ProgramSize = programSize;
+    }
+} // namespace chip8cpp
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp_explore/visited_set.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chip8cpp_explore
+{
+    // Command line options
+    struct ExploreOptions
+    {
+        std::string programFile;         // Program to explore
+        uint32_t    cyclesPerStep {10};  // Instructions run per input step
+        uint32_t    maxDepth {1000};     // Input steps before giving up on deeper states
+        size_t      maxStates {1000000}; // Unique states before stopping
+        uint32_t    threadCount {0};     // Worker threads, 0 for one per core
+        uint32_t    randomSeed {1};      // CXNN seed of the start state, so runs find the same states
+    };
+
+    // Input applied for one step, NoKey or the index of the only held key
+    using Input = int8_t;
+
+    constexpr Input NoKey = -1;
+
+    // Trap reached by the exploration, with the shortest input sequence that reaches it
+    struct Finding
+    {
+        chip8cpp::Trap     trap {}; // Trap the program stopped on
+        uint16_t           PC {0};  // Address of the trapping instruction
+        std::vector<Input> inputs;  // One input per step from the start of the program
+    };
+
+    // Breadth-first search over every input sequence of a program, one step holding no key or one of the 16 keys.
+    // States are deduplicated by Chip8::getStateHash(), so each level only expands states no shorter sequence reached.
+    // Levels are expanded by all threads in chunks, new states are stored packed until the next level expands them.
+    class Explorer
+    {
+    public:
+        Explorer()  = default;
+        ~Explorer() = default;
+
+        bool init(int argc, char* argv[]);
+        void run();
+
+    private:
+        // States of one level, packed back to back
+        struct Level
+        {
+            std::vector<uint8_t> states; // Packed checkpoints
+            std::vector<size_t>  ends;   // End offset of every state in states
+        };
+
+        // How a state was reached, to rebuild input sequences
+        struct PathNode
+        {
+            uint32_t parent {0};    // Index of the parent state in the previous level
+            Input    input {NoKey}; // Input applied to the parent
+        };
+
+        // New states found by one thread while expanding a level
+        struct WorkerOutput
+        {
+            Level                 level;
+            std::vector<PathNode> nodes;
+            size_t                expandedCount {0}; // Child states run, including the known ones
+        };
+
+        bool parseArguments(int argc, char* argv[]);
+
+        static chip8cpp::Config createConfig();
+
+        void expandLevel(uint32_t depth, WorkerOutput& output);
+        void recordFinding(const chip8cpp::Chip8& chip8, uint32_t depth, const PathNode& node);
+
+    private:
+        ExploreOptions                                m_Options;        // Command line options
+        std::shared_ptr<const chip8cpp::ProgramImage> m_Image;          // Program shared by every worker
+        std::unique_ptr<VisitedSet>                   m_Visited;        // Hashes of every state found
+        Level                                         m_Frontier;       // States of the level being expanded
+        std::vector<std::vector<PathNode>>            m_Paths;          // Path nodes of every level
+        std::atomic<size_t>                           m_NextState {0};  // Next frontier state to hand out
+        std::atomic<size_t>                           m_StateCount {0}; // Unique states found
+        std::vector<Finding>                          m_Findings;       // One finding per trap and address
+        std::mutex                                    m_FindingsMutex;  // Guards m_Findings
+    };
+} // namespace chip8cpp_explore
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace chip8cpp_explore
+{
+    // Set of state hashes shared by all explorer threads without locks. Open addressing with linear probing, a slot
+    // only ever changes once, from empty to a hash, so a compare-and-swap is all an insert needs.
+    // Hash 0 marks empty slots and is stored as 1, a collision the 64 bit hashes make negligible.
+    class VisitedSet
+    {
+    public:
+        explicit VisitedSet(size_t maxSize);
+
+        bool insert(uint64_t hash);
+
+        size_t getCapacity() const;
+        size_t getMemoryUsage() const;
+
+    private:
+        std::unique_ptr<std::atomic<uint64_t>[]> m_Slots;    // Hashes, 0 when empty
+        size_t                                   m_Mask {0}; // Capacity - 1, the capacity is a power of two
+    };
+} // namespace chip8cpp_explore
@@ -0,0 +1,346 @@
+#include <chip8cpp_explore/explorer.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // Upper bound of --cycles
+    constexpr uint32_t MaxCyclesPerStep = 1000;
+
+    // Frontier states a thread takes at a time, enough to keep the shared index off the hot path
+    constexpr size_t ChunkSize = 16;
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& value)
+    {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc {} && end == text.data() + text.size();
+    }
+
+    std::string formatInputs(const std::vector<chip8cpp_explore::Input>& inputs)
+    {
+        // Runs of the same input are written once with a count, e.g. "-*12 5 -*3"
+        std::string text;
+        for (size_t i = 0; i < inputs.size();)
+        {
+            size_t runEnd = i + 1;
+            while (runEnd < inputs.size() && inputs[runEnd] == inputs[i])
+            {
+                ++runEnd;
+            }
+
+            if (!text.empty())
+            {
+                text += ' ';
+            }
+            text += inputs[i] == chip8cpp_explore::NoKey ?
+                        "-" :
+                        chip8cpp::getKeyCodeName(static_cast<chip8cpp::KeyCode>(inputs[i]));
+            if (runEnd - i > 1)
+            {
+                text += std::format("*{}", runEnd - i);
+            }
+            i = runEnd;
+        }
+        return text;
+    }
+} // namespace
+
+namespace chip8cpp_explore
+{
+    bool Explorer::init(int argc, char* argv[])
+    {
+        if (!parseArguments(argc, argv))
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--cycles <per step>] [--depth <steps>] [--max-states <count>] [--threads <count>]"
+                         " [--seed <value>] program_file"
+                      << std::endl;
+            return false;
+        }
+
+        m_Image = chip8cpp::ProgramImage::loadFromFile(m_Options.programFile);
+        if (!m_Image)
+        {
+            std::cerr << "Failed to load program: " << m_Options.programFile << std::endl;
+            return false;
+        }
+
+        if (m_Options.threadCount == 0)
+        {
+            m_Options.threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        m_Visited = std::make_unique<VisitedSet>(m_Options.maxStates);
+        return true;
+    }
+
+    void Explorer::run()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const Clock::time_point start = Clock::now();
+
+        // The start of the program is the only state of the first level
+        chip8cpp::Chip8 chip8(createConfig());
+        chip8.loadProgram(m_Image);
+        chip8.setRandomSeed(m_Options.randomSeed); // The generator state is hashed, a system seed would vary the states
+
+        chip8cpp::Checkpoint checkpoint;
+        chip8.saveCheckpoint(checkpoint);
+        checkpoint.pack(m_Frontier.states);
+        m_Frontier.ends.push_back(m_Frontier.states.size());
+        m_Paths.push_back({PathNode {}});
+        m_Visited->insert(chip8.getStateHash());
+        m_StateCount = 1;
+
+        std::vector<WorkerOutput> outputs(m_Options.threadCount);
+        size_t                    expandedCount = 0;
+        size_t                    storedBytes   = m_Frontier.states.size();
+        size_t                    storedCount   = 1;
+        size_t                    peakBytes     = 0;
+        uint32_t                  depth         = 0;
+
+        for (; depth < m_Options.maxDepth && !m_Frontier.ends.empty() && m_StateCount < m_Options.maxStates; ++depth)
+        {
+            m_NextState = 0;
+
+            // The calling thread expands a share of the level itself
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < outputs.size(); ++i)
+            {
+                workers.emplace_back([this, depth, &output = outputs[i]]() { expandLevel(depth, output); });
+            }
+            expandLevel(depth, outputs[0]);
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+
+            // The new states of every thread, back to back, are the next level
+            Level                 next;
+            std::vector<PathNode> nodes;
+            for (WorkerOutput& output : outputs)
+            {
+                const size_t base = next.states.size();
+                next.states.insert(next.states.end(), output.level.states.begin(), output.level.states.end());
+                for (size_t end : output.level.ends)
+                {
+                    next.ends.push_back(base + end);
+                }
+                nodes.insert(nodes.end(), output.nodes.begin(), output.nodes.end());
+                expandedCount += output.expandedCount;
+
+                output.level.states.clear();
+                output.level.ends.clear();
+                output.nodes.clear();
+                output.expandedCount = 0;
+            }
+
+            peakBytes = std::max(peakBytes, m_Frontier.states.size() + next.states.size());
+            storedBytes += next.states.size();
+            storedCount += next.ends.size();
+
+            m_Frontier = std::move(next);
+            m_Paths.push_back(std::move(nodes));
+        }
+
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        // Unique states per second and what keeping one of them costs
+        const size_t stateCount = m_StateCount;
+        std::cout << std::format("{}: {} unique states in {} steps, {} runs of {} instructions\n",
+                                 m_Options.programFile,
+                                 stateCount,
+                                 depth,
+                                 expandedCount,
+                                 m_Options.cyclesPerStep);
+        std::cout << std::format("{:.2f} s on {} threads, {:.0f} unique states/s, {:.0f} runs/s\n",
+                                 elapsed.count(),
+                                 m_Options.threadCount,
+                                 stateCount / elapsed.count(),
+                                 expandedCount / elapsed.count());
+        std::cout << std::format("Memory: {:.1f} MB visited set, {:.1f} B per state at the --max-states limit, "
+                                 "{} B path and {:.1f} B packed checkpoint per state, peak {:.1f} MB of checkpoints\n",
+                                 m_Visited->getMemoryUsage() / (1024.0 * 1024.0),
+                                 static_cast<double>(m_Visited->getMemoryUsage()) / m_Options.maxStates,
+                                 sizeof(PathNode),
+                                 static_cast<double>(storedBytes) / storedCount,
+                                 peakBytes / (1024.0 * 1024.0));
+
+        if (m_Findings.empty())
+        {
+            std::cout << "No traps found" << std::endl;
+            return;
+        }
+
+        std::sort(m_Findings.begin(),
+                  m_Findings.end(),
+                  [](const Finding& a, const Finding& b) { return a.inputs.size() < b.inputs.size(); });
+        for (const Finding& finding : m_Findings)
+        {
+            std::cout << std::format("{} at {:#06x} after {} steps: {}\n",
+                                     chip8cpp::getTrapName(finding.trap),
+                                     finding.PC,
+                                     finding.inputs.size(),
+                                     formatInputs(finding.inputs));
+        }
+        std::cout.flush();
+    }
+
+    bool Explorer::parseArguments(int argc, char* argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--cycles" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.cyclesPerStep) || m_Options.cyclesPerStep == 0 ||
+                    m_Options.cyclesPerStep > MaxCyclesPerStep)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--depth" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.maxDepth))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--max-states" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.maxStates) || m_Options.maxStates == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--threads" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.threadCount))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--seed" && i + 1 < argc)
+            {
+                if (!parseNumber(argv[++i], m_Options.randomSeed))
+                {
+                    return false;
+                }
+            }
+            else if (argument.starts_with("--") || !m_Options.programFile.empty())
+            {
+                return false; // Unknown option or more than one program
+            }
+            else
+            {
+                m_Options.programFile = argument;
+            }
+        }
+
+        return !m_Options.programFile.empty();
+    }
+
+    chip8cpp::Config Explorer::createConfig()
+    {
+        chip8cpp::Config config {};
+        config.printTraps = false; // Traps are collected as findings
+#ifdef DEBUG
+        config.printKeyStates = false;
+#endif
+        return config;
+    }
+
+    void Explorer::expandLevel(uint32_t depth, WorkerOutput& output)
+    {
+        // Every thread runs its own instance, they all share the program's memory pages
+        chip8cpp::Chip8 chip8(createConfig());
+        chip8.loadProgram(m_Image);
+
+        chip8cpp::Checkpoint parent;
+        chip8cpp::Checkpoint child;
+
+        const size_t stateCount = m_Frontier.ends.size();
+        size_t       begin      = 0;
+        while ((begin = m_NextState.fetch_add(ChunkSize, std::memory_order_relaxed)) < stateCount)
+        {
+            const size_t end = std::min(begin + ChunkSize, stateCount);
+            for (size_t index = begin; index < end; ++index)
+            {
+                if (m_StateCount.load(std::memory_order_relaxed) >= m_Options.maxStates)
+                {
+                    return;
+                }
+
+                const size_t stateBegin = index == 0 ? 0 : m_Frontier.ends[index - 1];
+                parent.unpack(std::span(m_Frontier.states).subspan(stateBegin, m_Frontier.ends[index] - stateBegin));
+
+                size_t newCount = 0;
+                for (Input input = NoKey; input < static_cast<Input>(chip8cpp::constants::KeyCount); ++input)
+                {
+                    chip8.restoreCheckpoint(parent);
+                    for (size_t key = 0; key < chip8cpp::constants::KeyCount; ++key)
+                    {
+                        chip8.setKeyState(static_cast<chip8cpp::KeyCode>(key), static_cast<Input>(key) == input);
+                    }
+                    chip8.emulateCycles(m_Options.cyclesPerStep);
+                    ++output.expandedCount;
+
+                    if (!m_Visited->insert(chip8.getStateHash()))
+                    {
+                        continue; // Reached before, by a sequence no longer than this one
+                    }
+                    ++newCount;
+
+                    const PathNode node {static_cast<uint32_t>(index), input};
+                    if (chip8.getTrap() != chip8cpp::Trap::eNone)
+                    {
+                        recordFinding(chip8, depth, node); // The program stopped, nothing to expand
+                        continue;
+                    }
+
+                    chip8.saveCheckpoint(child);
+                    child.pack(output.level.states);
+                    output.level.ends.push_back(output.level.states.size());
+                    output.nodes.push_back(node);
+                }
+
+                m_StateCount.fetch_add(newCount, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void Explorer::recordFinding(const chip8cpp::Chip8& chip8, uint32_t depth, const PathNode& node)
+    {
+        const std::lock_guard lock(m_FindingsMutex);
+
+        const chip8cpp::Trap trap = chip8.getTrap();
+        const uint16_t       PC   = chip8.getPC(); // Traps leave the PC on the instruction
+        for (const Finding& finding : m_Findings)
+        {
+            if (finding.trap == trap && finding.PC == PC)
+            {
+                return;
+            }
+        }
+
+        // Walk the path nodes back to the first level
+        Finding  finding {trap, PC, {node.input}};
+        uint32_t parent = node.parent;
+        for (uint32_t level = depth; level > 0; --level)
+        {
+            const PathNode& step = m_Paths[level][parent];
+            finding.inputs.push_back(step.input);
+            parent = step.parent;
+        }
+        std::reverse(finding.inputs.begin(), finding.inputs.end());
+
+        m_Findings.push_back(std::move(finding));
+    }
+} // namespace chip8cpp_explore
@@ -0,0 +1,28 @@
+#include <chip8cpp_explore/explorer.hpp>
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+try
+{
+    chip8cpp_explore::Explorer explorer;
+
+    if (!explorer.init(argc, argv))
+    {
+        return 1;
+    }
+
+    explorer.run();
+
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Unknown exception occurred." << std::endl;
+    return 1;
+}
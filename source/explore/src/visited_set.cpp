@@ -0,0 +1,44 @@
+#include <chip8cpp_explore/visited_set.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace chip8cpp_explore
+{
+    VisitedSet::VisitedSet(size_t maxSize)
+    {
+        // At most half full, so probe sequences stay short
+        const size_t capacity = std::bit_ceil(std::max<size_t>(maxSize * 2, 64));
+        m_Slots               = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+        m_Mask                = capacity - 1;
+    }
+
+    bool VisitedSet::insert(uint64_t hash)
+    {
+        if (hash == 0)
+        {
+            hash = 1;
+        }
+
+        // The hashes are already well mixed, their low bits pick the first slot
+        for (size_t probe = 0, slot = hash & m_Mask; probe <= m_Mask; ++probe, slot = (slot + 1) & m_Mask)
+        {
+            uint64_t stored = m_Slots[slot].load(std::memory_order_relaxed);
+            if (stored == 0 &&
+                m_Slots[slot].compare_exchange_strong(stored, hash, std::memory_order_relaxed))
+            {
+                return true;
+            }
+            if (stored == hash)
+            {
+                return false; // Already there, or another thread inserted it first
+            }
+        }
+
+        return false; // Full, treat the state as visited
+    }
+
+    size_t VisitedSet::getCapacity() const { return m_Mask + 1; }
+
+    size_t VisitedSet::getMemoryUsage() const { return getCapacity() * sizeof(std::atomic<uint64_t>); }
+} // namespace chip8cpp_explore
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+#include <chip8cpp_term/terminal_input.hpp>
+#include <chip8cpp_term/terminal_renderer.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace chip8cpp_term
+{
+    // Command line options
+    struct TermOptions
+    {
+        std::string programFile;        // Program to load
+        std::string builtinProgram;     // Embedded program to load instead of a file
+        uint32_t    cyclesPerFrame {1}; // Instructions run per frame
+    };
+
+    // Runs the interpreter in a terminal, without SDL, e.g. over SSH
+    class TermApp
+    {
+    public:
+        TermApp()  = default;
+        ~TermApp() = default;
+
+        bool init(int argc, char* argv[]);
+        void run();
+
+    private:
+        bool parseArguments(int argc, char* argv[]);
+
+    private:
+        TermOptions      m_Options;  // Command line options
+        chip8cpp::Chip8  m_Chip8;    // Chip8 interpreter
+        TerminalInput    m_Input;    // Raw mode keyboard input
+        TerminalRenderer m_Renderer; // Incremental display output
+    };
+} // namespace chip8cpp_term
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include <termios.h>
+
+namespace chip8cpp_term
+{
+    // Reads keys from a terminal in raw mode, without blocking.
+    // Terminals only report presses, so a key counts as held for a few frames after each press or auto-repeat.
+    class TerminalInput
+    {
+    public:
+        TerminalInput();
+        ~TerminalInput();
+
+        TerminalInput(const TerminalInput&)            = delete;
+        TerminalInput& operator=(const TerminalInput&) = delete;
+
+        bool init(int fd);
+
+        void poll();
+
+        bool isKeyHeld(chip8cpp::KeyCode keyCode) const;
+        bool isQuitRequested() const;
+
+    private:
+        // Where the input is in an escape sequence, which can span several reads
+        enum class EscapeState : uint8_t
+        {
+            eNone = 0, // Not in a sequence
+            eEscape,   // After Esc, a sequence or Alt+key if more follows, Esc itself otherwise
+            eSequence, // In a CSI or SS3 sequence, until its final byte
+        };
+
+        void readByte(uint8_t byte);
+
+    private:
+        int     m_FD {-1};               // File descriptor of the terminal
+        bool    m_IsRaw {false};         // Whether the terminal was switched to raw mode
+        termios m_SavedTermios {};       // Terminal settings to restore on exit
+        bool    m_QuitRequested {false}; // Whether Esc or Ctrl+C was pressed
+
+        std::array<std::optional<chip8cpp::KeyCode>, 256> m_CharToKey {}; // Chip8 key of every input byte
+
+        uint8_t m_HeldFrames[chip8cpp::constants::KeyCount] {}; // Frames each key stays held for
+
+        EscapeState                           m_EscapeState {EscapeState::eNone}; // Escape sequence state
+        std::chrono::steady_clock::time_point m_EscapeTime;                       // When the pending Esc was read
+    };
+} // namespace chip8cpp_term
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chip8cpp/chip8cpp.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace chip8cpp_term
+{
+    // Draws the graphics buffer with ANSI escapes, two pixels per character cell using Unicode half blocks.
+    // Only the cells that changed since the last frame are sent, each frame goes out in a single write().
+    class TerminalRenderer
+    {
+    public:
+        TerminalRenderer() = default;
+        ~TerminalRenderer();
+
+        TerminalRenderer(const TerminalRenderer&)            = delete;
+        TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+        bool init(int fd);
+
+        void setStatus(std::string_view status);
+        void beep();
+        void present(const uint64_t* gfx);
+
+        size_t getLastFrameBytes() const;
+
+    private:
+        void moveCursor(size_t row, size_t column);
+        void appendCell(const uint64_t* gfx, size_t cellRow, size_t column);
+        bool writeAll(std::string_view bytes);
+
+    private:
+        int  m_FD {-1};             // File descriptor of the terminal
+        bool m_Initialized {false}; // Whether the terminal was switched to the alternate screen
+        bool m_HasShown {false};    // Whether m_Shown holds what is on screen
+
+        uint64_t    m_Shown[chip8cpp::constants::Height] {}; // Graphics buffer currently on screen
+        std::string m_Buffer;                                // Escapes and glyphs of the frame being built
+        std::string m_Status;                                // Status line shown below the display
+        bool        m_StatusChanged {false};                 // Whether the status line has to be redrawn
+        bool        m_Beep {false};                          // Whether to ring the bell with the next frame
+        size_t      m_LastFrameBytes {0};                    // Bytes written for the last frame
+    };
+} // namespace chip8cpp_term
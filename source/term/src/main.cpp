@@ -0,0 +1,28 @@
+#include <chip8cpp_term/term_app.hpp>
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+try
+{
+    chip8cpp_term::TermApp app;
+
+    if (!app.init(argc, argv))
+    {
+        return 1;
+    }
+
+    app.run();
+
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Unknown exception occurred." << std::endl;
+    return 1;
+}
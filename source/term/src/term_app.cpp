@@ -0,0 +1,166 @@
+#include <chip8cpp_term/term_app.hpp>
+
+#include <chip8cpp_programs.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace
+{
+    // Builtin test program loaded when none is given
+    constexpr const char* DefaultBuiltinProgram = "2-ibm-logo";
+
+    // Upper bound of --cycles
+    constexpr uint32_t MaxCyclesPerFrame = 1000;
+
+    constexpr uint32_t FrameRate = 60; // Frames per second, the rate of the Chip8 timers
+} // namespace
+
+namespace chip8cpp_term
+{
+    bool TermApp::init(int argc, char* argv[])
+    {
+        if (!parseArguments(argc, argv))
+        {
+            std::cerr << "Usage: " << argv[0] << " [--cycles <per frame>] [program_file | --builtin <name>]"
+                      << std::endl;
+            return false;
+        }
+
+        if (m_Options.programFile.empty() && m_Options.builtinProgram.empty())
+        {
+            m_Options.builtinProgram = DefaultBuiltinProgram;
+        }
+
+        chip8cpp::Config config {};
+        config.soundCallback = [this]() { m_Renderer.beep(); }; // Ring the terminal bell
+#ifdef DEBUG
+        config.printKeyStates = false; // Would scroll the display away
+#endif
+        m_Chip8.setConfig(config);
+
+        if (!m_Options.builtinProgram.empty())
+        {
+            // Builtin programs are embedded in the binary and mapped without copying
+            const std::span<const uint8_t> program = chip8cpp_programs::findProgram(m_Options.builtinProgram);
+            if (program.empty() || !m_Chip8.loadProgramView(program))
+            {
+                std::cerr << "Failed to load builtin program: " << m_Options.builtinProgram << std::endl;
+                std::cerr << "Builtin programs:";
+                for (const chip8cpp_programs::EmbeddedProgram& builtin : chip8cpp_programs::EmbeddedPrograms)
+                {
+                    std::cerr << " " << builtin.name;
+                }
+                std::cerr << std::endl;
+                return false;
+            }
+        }
+        else if (!m_Chip8.loadProgram(m_Options.programFile))
+        {
+            std::cerr << "Failed to load program: " << m_Options.programFile << std::endl;
+            return false;
+        }
+
+        if (!m_Input.init(STDIN_FILENO) || !m_Renderer.init(STDOUT_FILENO))
+        {
+            std::cerr << "Standard input and output must be a terminal." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    void TermApp::run()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const Clock::duration frameInterval =
+            std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / FrameRate;
+
+        Clock::time_point deadline    = Clock::now();
+        Clock::time_point statusStart = deadline;
+        uint32_t          frameCount  = 0;
+        size_t            frameBytes  = 0;
+
+        while (true)
+        {
+            m_Input.poll();
+            if (m_Input.isQuitRequested())
+            {
+                return;
+            }
+
+            for (size_t i = 0; i < chip8cpp::constants::KeyCount; ++i)
+            {
+                const auto keyCode = static_cast<chip8cpp::KeyCode>(i);
+                m_Chip8.setKeyState(keyCode, m_Input.isKeyHeld(keyCode));
+            }
+
+            m_Chip8.emulateCycles(m_Options.cyclesPerFrame);
+
+            // Show the frame rate and output size about once per second
+            ++frameCount;
+            if (frameCount == FrameRate)
+            {
+                const Clock::time_point             now     = Clock::now();
+                const std::chrono::duration<double> elapsed = now - statusStart;
+                m_Renderer.setStatus(std::format("{:.1f} FPS, {} bytes/frame, Esc to quit",
+                                                 frameCount / elapsed.count(),
+                                                 frameBytes / frameCount));
+                statusStart = now;
+                frameCount  = 0;
+                frameBytes  = 0;
+            }
+
+            m_Renderer.present(m_Chip8.getGFX());
+            frameBytes += m_Renderer.getLastFrameBytes();
+
+            // Absolute deadlines, so sleeping late on one frame doesn't slow down the following ones
+            deadline += frameInterval;
+            const Clock::time_point now = Clock::now();
+            if (now > deadline + frameInterval)
+            {
+                deadline = now; // Fell far behind, e.g. the terminal blocked, don't try to catch up
+            }
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+
+    bool TermApp::parseArguments(int argc, char* argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--cycles" && i + 1 < argc)
+            {
+                const std::string_view cycles = argv[++i];
+                const auto [end, error] =
+                    std::from_chars(cycles.data(), cycles.data() + cycles.size(), m_Options.cyclesPerFrame);
+                if (error != std::errc {} || end != cycles.data() + cycles.size() || m_Options.cyclesPerFrame == 0 ||
+                    m_Options.cyclesPerFrame > MaxCyclesPerFrame)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--builtin" && i + 1 < argc && m_Options.programFile.empty())
+            {
+                m_Options.builtinProgram = argv[++i];
+            }
+            else if (argument.starts_with("--") || !m_Options.programFile.empty() || !m_Options.builtinProgram.empty())
+            {
+                return false; // Unknown option or more than one program
+            }
+            else
+            {
+                m_Options.programFile = argument;
+            }
+        }
+
+        return true;
+    }
+} // namespace chip8cpp_term
@@ -0,0 +1,156 @@
+#include <chip8cpp_term/terminal_input.hpp>
+
+#include <unistd.h>
+
+namespace
+{
+    // Same layout as the SDL app, indexed by KeyCode
+    // __  __  __  __
+    // |1 ||2 ||3 ||4 |
+    //   |Q ||W ||E ||R |
+    //     |A ||S ||D ||F |
+    //       |Z ||X ||C ||V |
+    //       __  __  __  __
+    constexpr char KeyChars[chip8cpp::constants::KeyCount] = {
+        '1', '2', '3', '4', 'q', 'w', 'e', 'r', 'a', 's', 'd', 'f', 'z', 'x', 'c', 'v'};
+
+    // Frames a key stays held after a press, long enough to bridge the gaps between auto-repeats
+    constexpr uint8_t KeyHoldFrames = 6;
+
+    // Time Esc waits for the rest of an escape sequence before it counts as a key press
+    constexpr std::chrono::milliseconds EscapeTimeout {100};
+
+    constexpr uint8_t CtrlC  = 0x03;
+    constexpr uint8_t Escape = 0x1B;
+} // namespace
+
+namespace chip8cpp_term
+{
+    TerminalInput::TerminalInput()
+    {
+        for (size_t i = 0; i < chip8cpp::constants::KeyCount; ++i)
+        {
+            const auto    keyCode = static_cast<chip8cpp::KeyCode>(i);
+            const uint8_t lower   = static_cast<uint8_t>(KeyChars[i]);
+            m_CharToKey[lower]    = keyCode;
+            if (lower >= 'a' && lower <= 'z')
+            {
+                m_CharToKey[lower - 'a' + 'A'] = keyCode; // Caps lock
+            }
+        }
+    }
+
+    TerminalInput::~TerminalInput()
+    {
+        if (m_IsRaw)
+        {
+            tcsetattr(m_FD, TCSAFLUSH, &m_SavedTermios);
+        }
+    }
+
+    bool TerminalInput::init(int fd)
+    {
+        if (!isatty(fd) || tcgetattr(fd, &m_SavedTermios) != 0)
+        {
+            return false;
+        }
+
+        // No line buffering, echo or signal keys, and reads return at once with whatever is pending
+        termios raw = m_SavedTermios;
+        raw.c_iflag &= ~(IXON | ICRNL);
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+        raw.c_cc[VMIN]  = 0;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(fd, TCSAFLUSH, &raw) != 0)
+        {
+            return false;
+        }
+
+        m_FD    = fd;
+        m_IsRaw = true;
+        return true;
+    }
+
+    void TerminalInput::poll()
+    {
+        for (uint8_t& heldFrames : m_HeldFrames)
+        {
+            if (heldFrames > 0)
+            {
+                --heldFrames;
+            }
+        }
+
+        uint8_t buffer[64];
+        ssize_t size = 0;
+        while ((size = read(m_FD, buffer, sizeof(buffer))) > 0)
+        {
+            for (ssize_t i = 0; i < size; ++i)
+            {
+                readByte(buffer[i]);
+            }
+        }
+
+        // Over SSH an escape sequence can arrive split across reads, Esc alone only quits once nothing followed it
+        if (m_EscapeState == EscapeState::eEscape && std::chrono::steady_clock::now() - m_EscapeTime >= EscapeTimeout)
+        {
+            m_QuitRequested = true;
+            m_EscapeState   = EscapeState::eNone;
+        }
+    }
+
+    bool TerminalInput::isKeyHeld(chip8cpp::KeyCode keyCode) const
+    {
+        return m_HeldFrames[static_cast<size_t>(keyCode)] > 0;
+    }
+
+    bool TerminalInput::isQuitRequested() const { return m_QuitRequested; }
+
+    void TerminalInput::readByte(uint8_t byte)
+    {
+        switch (m_EscapeState)
+        {
+            case EscapeState::eEscape:
+                if (byte == '[' || byte == 'O')
+                {
+                    m_EscapeState = EscapeState::eSequence; // CSI or SS3, e.g. the arrow keys
+                    return;
+                }
+                if (byte == Escape)
+                {
+                    m_QuitRequested = true; // The first Esc was pressed alone
+                    m_EscapeTime    = std::chrono::steady_clock::now();
+                    return;
+                }
+                m_EscapeState = EscapeState::eNone; // Alt+key, the key still counts
+                break;
+            case EscapeState::eSequence:
+                if (byte >= 0x20 && byte <= 0x3F)
+                {
+                    return; // Parameter and intermediate bytes
+                }
+                m_EscapeState = EscapeState::eNone;
+                if (byte >= 0x40 && byte <= 0x7E)
+                {
+                    return; // Final byte
+                }
+                break; // Not part of a sequence, read it on its own
+            case EscapeState::eNone:
+                break;
+        }
+
+        if (byte == CtrlC)
+        {
+            m_QuitRequested = true;
+        }
+        else if (byte == Escape)
+        {
+            m_EscapeState = EscapeState::eEscape;
+            m_EscapeTime  = std::chrono::steady_clock::now();
+        }
+        else if (m_CharToKey[byte])
+        {
+            m_HeldFrames[static_cast<size_t>(*m_CharToKey[byte])] = KeyHoldFrames;
+        }
+    }
+} // namespace chip8cpp_term
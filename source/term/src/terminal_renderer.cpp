@@ -0,0 +1,174 @@
+#include <chip8cpp_term/terminal_renderer.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <iterator>
+
+#include <unistd.h>
+
+namespace
+{
+    constexpr uint64_t PixelMask = 0x8000000000000000; // Bit of the leftmost pixel in a graphics buffer row
+
+    // Glyph of a cell, indexed by (top pixel << 1) | bottom pixel
+    constexpr const char* CellGlyphs[4] = {" ", "▄", "▀", "█"};
+
+    // Unchanged cells between two changed ones are redrawn instead of moving the cursor when there are this few,
+    // a cursor move costs up to 8 bytes and a cell at most 3
+    constexpr size_t MaxBridgedCells = 2;
+
+    constexpr size_t CellRows  = chip8cpp::constants::Height / 2;
+    constexpr size_t StatusRow = CellRows + 1; // Row of the status line below the display, zero-based
+} // namespace
+
+namespace chip8cpp_term
+{
+    TerminalRenderer::~TerminalRenderer()
+    {
+        if (m_Initialized)
+        {
+            // Show the cursor and leave the alternate screen
+            writeAll("\033[0m\033[?25h\033[?1049l");
+        }
+    }
+
+    bool TerminalRenderer::init(int fd)
+    {
+        if (!isatty(fd))
+        {
+            return false;
+        }
+
+        m_FD = fd;
+
+        // Switch to the alternate screen, hide the cursor and clear
+        if (!writeAll("\033[?1049h\033[?25l\033[2J"))
+        {
+            return false;
+        }
+
+        // The first frame goes out in full, so it overwrites whatever the terminal shows
+        m_Buffer.reserve(4096);
+        m_HasShown    = false;
+        m_Initialized = true;
+        return true;
+    }
+
+    void TerminalRenderer::setStatus(std::string_view status)
+    {
+        if (status != m_Status)
+        {
+            m_Status        = status;
+            m_StatusChanged = true;
+        }
+    }
+
+    void TerminalRenderer::beep() { m_Beep = true; }
+
+    void TerminalRenderer::present(const uint64_t* gfx)
+    {
+        m_Buffer.clear();
+
+        for (size_t cellRow = 0; cellRow < CellRows; ++cellRow)
+        {
+            const size_t top    = cellRow * 2;
+            const size_t bottom = top + 1;
+
+            uint64_t changed = ~uint64_t {0};
+            if (m_HasShown)
+            {
+                changed = (gfx[top] ^ m_Shown[top]) | (gfx[bottom] ^ m_Shown[bottom]);
+            }
+
+            // Walk the changed cells from left to right, only moving the cursor across longer gaps
+            size_t cursorColumn = chip8cpp::constants::Width + MaxBridgedCells + 1; // Unknown
+            while (changed != 0)
+            {
+                const size_t column = std::countl_zero(changed);
+                if (column < cursorColumn || column - cursorColumn > MaxBridgedCells)
+                {
+                    moveCursor(cellRow, column);
+                }
+                else
+                {
+                    for (; cursorColumn < column; ++cursorColumn)
+                    {
+                        appendCell(gfx, cellRow, cursorColumn);
+                    }
+                }
+
+                appendCell(gfx, cellRow, column);
+                cursorColumn = column + 1;
+                changed &= ~(PixelMask >> column);
+            }
+        }
+
+        if (m_StatusChanged)
+        {
+            moveCursor(StatusRow, 0);
+            m_Buffer += m_Status;
+            m_Buffer += "\033[K"; // Clear the rest of the line
+            m_StatusChanged = false;
+        }
+
+        if (m_Beep)
+        {
+            m_Buffer += '\a';
+            m_Beep = false;
+        }
+
+        m_LastFrameBytes = m_Buffer.size();
+        if (!m_Buffer.empty() && !writeAll(m_Buffer))
+        {
+            // Part of the frame may be on screen, so the next one goes out in full, status line included
+            m_HasShown      = false;
+            m_StatusChanged = true;
+            return;
+        }
+
+        std::copy(gfx, gfx + chip8cpp::constants::Height, m_Shown);
+        m_HasShown = true;
+    }
+
+    size_t TerminalRenderer::getLastFrameBytes() const { return m_LastFrameBytes; }
+
+    void TerminalRenderer::moveCursor(size_t row, size_t column)
+    {
+        // Escape coordinates start at 1
+        char  escape[24] = "\033["; // Room for two 10 digit numbers
+        char* end        = std::to_chars(escape + 2, escape + 12, row + 1).ptr;
+        *end++           = ';';
+        end              = std::to_chars(end, end + 10, column + 1).ptr;
+        *end++           = 'H';
+        m_Buffer.append(escape, end);
+    }
+
+    void TerminalRenderer::appendCell(const uint64_t* gfx, size_t cellRow, size_t column)
+    {
+        const uint64_t mask     = PixelMask >> column;
+        const bool     isTop    = (gfx[cellRow * 2] & mask) != 0;
+        const bool     isBottom = (gfx[cellRow * 2 + 1] & mask) != 0;
+        m_Buffer += CellGlyphs[(isTop ? 2 : 0) | (isBottom ? 1 : 0)];
+    }
+
+    bool TerminalRenderer::writeAll(std::string_view bytes)
+    {
+        // A single write() unless the terminal takes the frame in parts
+        while (!bytes.empty())
+        {
+            const ssize_t written = write(m_FD, bytes.data(), bytes.size());
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            bytes.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+} // namespace chip8cpp_term